@@ -0,0 +1,791 @@
+// Benchmarks for every public API in string_util.hpp, next to the standard
+// library baselines they replace.
+//
+//   string_utils_bench [--filter <text>] [--min-time <seconds>] [--json <file>|-]
+//
+// Each case reports ns/op, bytes/s and heap allocations per op; the global
+// operator new is replaced to count them. --json writes the same numbers in a
+// stable shape for comparing runs between versions; with "--json -" the
+// table goes to stderr so stdout holds only the JSON document.
+#include "string_util.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	std::atomic<uint64_t> g_allocs{};
+	std::atomic<uint64_t> g_alloc_bytes{};
+}
+
+// operator new and delete below are a malloc/free pair; GCC flags them once inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t size) {
+	g_allocs.fetch_add(1, std::memory_order_relaxed);
+	g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+	// -------------------------------------------------------------------
+	// Harness.
+	// -------------------------------------------------------------------
+#if defined(__GNUC__) || defined(__clang__)
+	template<class _Type>
+	inline void Keep(const _Type& value) {
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+#else
+	const void* volatile g_sink;
+	template<class _Type>
+	inline void Keep(const _Type& value) {
+		g_sink = &value;
+	}
+#endif
+
+	struct Result {
+		std::string name;
+		size_t bytes;
+		uint64_t iterations;
+		double ns;
+		double allocs;
+		double allocBytes;
+	};
+
+	class Runner {
+	public:
+		std::string filter;
+		double minTime{ 0.2 };
+		FILE* log{ stdout };	// the table; stderr when the JSON goes to stdout.
+		std::vector<Result> results;
+
+		// bytes: input processed by one call of fn, used for bytes/s.
+		template<class _Fn>
+		void Run(const std::string& name, size_t bytes, _Fn&& fn) {
+			if (!filter.empty() && name.find(filter) == std::string::npos) {
+				return;
+			}
+			using Clock = std::chrono::steady_clock;
+			fn();
+			uint64_t iterations = 1;
+			while (true) {
+				uint64_t allocs = g_allocs.load();
+				uint64_t allocBytes = g_alloc_bytes.load();
+				auto start = Clock::now();
+				for (uint64_t i = 0; i < iterations; ++i) {
+					fn();
+				}
+				double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+				if (elapsed >= minTime || iterations >= (uint64_t{ 1 } << 32)) {
+					Result result{ name, bytes, iterations, elapsed * 1e9 / iterations,
+						double(g_allocs.load() - allocs) / iterations,
+						double(g_alloc_bytes.load() - allocBytes) / iterations };
+					Print(result);
+					results.push_back(std::move(result));
+					return;
+				}
+				double scale = elapsed > 0 ? minTime / elapsed * 1.2 : 10.0;
+				iterations = static_cast<uint64_t>(iterations * std::min(std::max(scale, 2.0), 10.0));
+			}
+		}
+		static double BytesPerSecond(const Result& result) {
+			return result.ns > 0 ? result.bytes * 1e9 / result.ns : 0;
+		}
+		void Print(const Result& result) const {
+			std::fprintf(log, "%-52s %12.1f ns/op %10.1f MB/s %8.2f allocs/op\n", result.name.c_str(),
+				result.ns, BytesPerSecond(result) / 1e6, result.allocs);
+			std::fflush(log);
+		}
+		void WriteJson(std::ostream& out) const {
+			static const char* levels[] = { "scalar", "sse2", "avx2" };
+			out << "{\n  \"library\": \"string_util\",\n";
+			out << "  \"simd\": \"" << levels[static_cast<int>(cpp::detail::CurrentSimdLevel())] << "\",\n";
+			out << "  \"min_time\": " << minTime << ",\n  \"results\": [\n";
+			for (size_t i = 0; i < results.size(); ++i) {
+				const auto& result = results[i];
+				out << "    {\"name\": \"" << result.name << "\", \"bytes_per_op\": " << result.bytes
+					<< ", \"iterations\": " << result.iterations << ", \"ns_per_op\": " << result.ns
+					<< ", \"bytes_per_second\": " << BytesPerSecond(result) << ", \"allocs_per_op\": " << result.allocs
+					<< ", \"alloc_bytes_per_op\": " << result.allocBytes << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+			}
+			out << "  ]\n}\n";
+		}
+	};
+
+	// -------------------------------------------------------------------
+	// Inputs.
+	// -------------------------------------------------------------------
+	struct Random {
+		uint32_t state{ 12345 };
+		uint32_t operator()(uint32_t bound) {
+			state = state * 1664525u + 1013904223u;
+			return (state >> 8) % bound;
+		}
+	};
+	// count fields of 1..2*fieldSize letters; every fourth one is space padded.
+	std::string MakeFields(size_t count, size_t fieldSize, char delim) {
+		Random random;
+		std::string result;
+		for (size_t i = 0; i < count; ++i) {
+			if (i) {
+				result += delim;
+			}
+			if (i % 4 == 3) {
+				result += ' ';
+			}
+			size_t size = 1 + random(static_cast<uint32_t>(fieldSize * 2));
+			for (size_t j = 0; j < size; ++j) {
+				result += static_cast<char>((random(2) ? 'a' : 'A') + random(26));
+			}
+			if (i % 4 == 3) {
+				result += ' ';
+			}
+		}
+		return result;
+	}
+	std::wstring Widen(const std::string& text) {
+		return std::wstring(text.begin(), text.end());
+	}
+	std::string MakeUtf8(size_t size) {
+		static const char* words[] = { "Hello", "\xC3\x84rger", "\xCE\x95\xCE\xBB\xCE\xBB\xCE\xAC\xCE\xB4\xCE\xB1",
+			"\xD0\x9C\xD0\xBE\xD1\x81\xD0\xBA\xD0\xB2\xD0\xB0", "Stra\xC3\x9F" "e", "WORLD" };
+		Random random;
+		std::string result;
+		while (result.size() < size) {
+			result += words[random(6)];
+			result += ' ';
+		}
+		return result;
+	}
+	// rows of numbers, words and quoted fields holding delimiters, "" and newlines.
+	std::string MakeCsv(size_t rows) {
+		Random random;
+		std::string result;
+		for (size_t i = 0; i < rows; ++i) {
+			result += std::to_string(i) + ",name" + std::to_string(random(1000)) + "," + std::to_string(random(100000));
+			switch (random(4)) {
+			case 0:
+				result += ",\"quoted, with comma\"";
+				break;
+			case 1:
+				result += ",\"say \"\"hi\"\"\"";
+				break;
+			case 2:
+				result += ",\"two\nlines\"";
+				break;
+			default:
+				result += ",plain";
+				break;
+			}
+			result += i % 2 ? "\r\n" : "\n";
+		}
+		return result;
+	}
+	struct Inputs {
+		std::string shortLine = MakeFields(4, 4, ',');
+		std::string fewTokens = MakeFields(16, 256, ',');
+		std::string manyTokens = MakeFields(16 * 1024, 4, ',');
+		std::string huge = MakeFields(1024 * 1024, 6, ',');
+		std::string mixedDelims = MakeFields(16 * 1024, 4, ';');
+		std::wstring wideShort = Widen(shortLine);
+		std::wstring wideMany = Widen(manyTokens);
+		std::string paddedShort = "   " + shortLine + "   ";
+		std::string paddedLong = std::string(64, ' ') + fewTokens + std::string(64, ' ');
+		std::wstring widePadded = Widen(paddedShort);
+		std::string asciiText = MakeFields(8 * 1024, 8, ' ');
+		std::wstring wideText = Widen(asciiText);
+		std::string utf8Text = MakeUtf8(64 * 1024);
+		std::string csv = MakeCsv(4 * 1024);
+		Inputs() {
+			// a few ',' between the ';' for the delimiter-set cases.
+			for (size_t i = 0; i < mixedDelims.size(); i += 97) {
+				if (mixedDelims[i] == ';') {
+					mixedDelims[i] = ',';
+				}
+			}
+		}
+	};
+	struct Input {
+		const char* label;
+		const std::string* text;
+	};
+
+	// -------------------------------------------------------------------
+	// Cases.
+	// -------------------------------------------------------------------
+	std::vector<std::string> GetlineSplit(const std::string& text, char delim) {
+		std::vector<std::string> result;
+		std::istringstream stream(text);
+		std::string token;
+		while (std::getline(stream, token, delim)) {
+			result.push_back(token);
+		}
+		if (!text.empty() && text.back() == delim) {
+			result.emplace_back();
+		}
+		return result;
+	}
+
+	void BenchTrim(Runner& runner, const Inputs& in) {
+		for (auto input : { Input{ "short", &in.paddedShort }, Input{ "long", &in.paddedLong } }) {
+			std::string prefix = std::string("trim/") + input.label + "/";
+			const std::string& text = *input.text;
+			runner.Run(prefix + "baseline_find_first_not_of", text.size(), [&] {
+				auto first = text.find_first_not_of(' ');
+				auto last = text.find_last_not_of(' ');
+				Keep(text.substr(first, last - first + 1));
+			});
+			runner.Run(prefix + "Trim", text.size(), [&] { Keep(cpp::Trim(text)); });
+			runner.Run(prefix + "TrimView", text.size(), [&] { Keep(cpp::TrimView(text)); });
+			runner.Run(prefix + "TrimView_AsciiSpace", text.size(), [&] { Keep(cpp::TrimView<cpp::AsciiSpace>(text)); });
+			runner.Run(prefix + "TrimView_UnicodeSpace", text.size(), [&] { Keep(cpp::TrimView<cpp::UnicodeSpace>(text)); });
+			runner.Run(prefix + "LTrim", text.size(), [&] { Keep(cpp::LTrim(text)); });
+			runner.Run(prefix + "RTrim", text.size(), [&] { Keep(cpp::RTrim(text)); });
+			std::string buffer;
+			runner.Run(prefix + "Trim_inplace", text.size(), [&] {
+				buffer = text;
+				cpp::Trim(&buffer);
+				Keep(buffer);
+			});
+		}
+		runner.Run("trim/short/wchar_t/Trim_inplace", in.widePadded.size() * sizeof(wchar_t), [&] {
+			std::wstring buffer = in.widePadded;
+			cpp::Trim(&buffer);
+			Keep(buffer);
+		});
+	}
+
+	void BenchSplit(Runner& runner, const Inputs& in) {
+		const Input inputs[] = { { "short", &in.shortLine }, { "few_tokens", &in.fewTokens }, { "many_tokens", &in.manyTokens } };
+		for (auto input : inputs) {
+			std::string prefix = std::string("split/") + input.label + "/";
+			const std::string& text = *input.text;
+			const std::string_view view(text);
+			runner.Run(prefix + "baseline_getline", text.size(), [&] { Keep(GetlineSplit(text, ',')); });
+			runner.Run(prefix + "Split", text.size(), [&] { Keep(cpp::Split(text, ',')); });
+			runner.Run(prefix + "SplitTrim", text.size(), [&] { Keep(cpp::SplitTrim(text, ',')); });
+			runner.Run(prefix + "SplitTrim_AsciiSpace", text.size(), [&] { Keep(cpp::SplitTrim<cpp::AsciiSpace>(text, ',')); });
+			runner.Run(prefix + "Split_set", text.size(), [&] { Keep(cpp::Split(text, ",;")); });
+			std::vector<std::string> reused;
+			runner.Run(prefix + "Split_reused_vector", text.size(), [&] {
+				reused.clear();
+				cpp::Split(text, ',', &reused);
+				Keep(reused);
+			});
+			cpp::TokenArena<char> arena;
+			runner.Run(prefix + "Split_TokenArena", text.size(), [&] {
+				arena.clear();
+				cpp::Split(view, ',', &arena);
+				Keep(arena);
+			});
+			std::vector<std::byte> buffer(4 * text.size() + 4096);
+			runner.Run(prefix + "pmr_Split_monotonic", text.size(), [&] {
+				std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size());
+				Keep(cpp::pmr::Split(text, ',', &resource));
+			});
+			runner.Run(prefix + "SplitView", text.size(), [&] {
+				size_t total = 0;
+				for (auto token : cpp::SplitView(view, ',')) {
+					total += token.size();
+				}
+				Keep(total);
+			});
+			runner.Run(prefix + "SplitTrimView", text.size(), [&] {
+				size_t total = 0;
+				for (auto token : cpp::SplitTrimView(view, ',')) {
+					total += token.size();
+				}
+				Keep(total);
+			});
+			runner.Run(prefix + "StreamSplit_memory", text.size(), [&] {
+				size_t total = 0;
+				cpp::StreamSplit(cpp::MemorySource<char>{ text.data(), text.data() + text.size() }, ',',
+					[&](std::string_view token) { total += token.size(); });
+				Keep(total);
+			});
+			runner.Run(prefix + "StreamSplit_istream", text.size(), [&] {
+				std::istringstream stream(text);
+				size_t total = 0;
+				cpp::StreamSplit(stream, ',', [&](std::string_view token) { total += token.size(); });
+				Keep(total);
+			});
+		}
+		runner.Run("split/delim_set/baseline_find_first_of", in.mixedDelims.size(), [&] {
+			std::vector<std::string> result;
+			size_t pos = 0;
+			while (true) {
+				size_t next = in.mixedDelims.find_first_of(",;", pos);
+				result.emplace_back(in.mixedDelims, pos, next == std::string::npos ? std::string::npos : next - pos);
+				if (next == std::string::npos) {
+					break;
+				}
+				pos = next + 1;
+			}
+			Keep(result);
+		});
+		runner.Run("split/delim_set/Split", in.mixedDelims.size(), [&] { Keep(cpp::Split(in.mixedDelims, ",;")); });
+		for (auto input : { std::make_pair("short", &in.wideShort), std::make_pair("many_tokens", &in.wideMany) }) {
+			const std::wstring& text = *input.second;
+			std::string prefix = std::string("split/") + input.first + "/wchar_t/";
+			runner.Run(prefix + "Split", text.size() * sizeof(wchar_t), [&] { Keep(cpp::Split(text, L',')); });
+			runner.Run(prefix + "SplitTrim_set", text.size() * sizeof(wchar_t), [&] { Keep(cpp::SplitTrim(text, L",;")); });
+		}
+
+		const std::string_view huge(in.huge);
+		std::vector<std::string_view> views;
+		runner.Run("split/huge/Split_views_serial", huge.size(), [&] {
+			views.clear();
+			cpp::ParallelOptions options;
+			options.threads = 1;
+			cpp::ParallelSplit(huge, ',', &views, options);
+			Keep(views);
+		});
+		runner.Run("split/huge/ParallelSplit_views", huge.size(), [&] {
+			views.clear();
+			cpp::ParallelSplit(huge, ',', &views);
+			Keep(views);
+		});
+		runner.Run("split/huge/ParallelSplitTrim", huge.size(), [&] { Keep(cpp::ParallelSplitTrim(in.huge, ',')); });
+	}
+
+	void BenchCase(Runner& runner, const Inputs& in) {
+		const std::string& text = in.asciiText;
+		std::string buffer;
+		runner.Run("case/ascii/baseline_transform_tolower", text.size(), [&] {
+			buffer = text;
+			std::transform(buffer.begin(), buffer.end(), buffer.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+			Keep(buffer);
+		});
+		runner.Run("case/ascii/ToLower", text.size(), [&] { Keep(cpp::ToLower(text)); });
+		runner.Run("case/ascii/ToUpper", text.size(), [&] { Keep(cpp::ToUpper(text)); });
+		runner.Run("case/ascii/ToLower_inplace", text.size(), [&] {
+			buffer = text;
+			cpp::ToLower(&buffer);
+			Keep(buffer);
+		});
+		runner.Run("case/ascii/short/ToLower", in.shortLine.size(), [&] { Keep(cpp::ToLower(in.shortLine)); });
+		runner.Run("case/ascii/wchar_t/ToLower", in.wideText.size() * sizeof(wchar_t), [&] { Keep(cpp::ToLower(in.wideText)); });
+		runner.Run("case/ascii/ToLowerUtf8", text.size(), [&] { Keep(cpp::ToLowerUtf8(text)); });
+		runner.Run("case/utf8/ToLower_bytes", in.utf8Text.size(), [&] { Keep(cpp::ToLower(in.utf8Text)); });
+		runner.Run("case/utf8/ToLowerUtf8", in.utf8Text.size(), [&] { Keep(cpp::ToLowerUtf8(in.utf8Text)); });
+		runner.Run("case/utf8/ToUpperUtf8", in.utf8Text.size(), [&] { Keep(cpp::ToUpperUtf8(in.utf8Text)); });
+	}
+
+	void BenchConcat(Runner& runner, const Inputs& in) {
+		const std::string name = "request";
+		const std::string& value = in.shortLine;
+		const int id = 421337;
+		const double ratio = 0.8125;
+		const size_t bytes = name.size() + value.size();
+		runner.Run("concat/baseline_operator_plus", bytes, [&] {
+			Keep(name + ":" + std::to_string(id) + ":" + value + ":" + std::to_string(ratio));
+		});
+		runner.Run("concat/baseline_ostringstream", bytes, [&] {
+			std::ostringstream stream;
+			stream << name << ':' << id << ':' << value << ':' << ratio;
+			Keep(stream.str());
+		});
+		runner.Run("concat/baseline_snprintf", bytes, [&] {
+			char buffer[256];
+			int size = std::snprintf(buffer, sizeof(buffer), "%s:%d:%s:%g", name.c_str(), id, value.c_str(), ratio);
+			Keep(std::string(buffer, size));
+		});
+		runner.Run("concat/Concat", bytes, [&] { Keep(cpp::Concat<char>(name, ":", id, ":", value, ":", ratio)); });
+		runner.Run("concat/Concat_strings_only", bytes, [&] { Keep(cpp::Concat<char>(name, ":", value, ":", name)); });
+		std::string target;
+		runner.Run("concat/ConcatTo_reused_string", bytes, [&] {
+			target.clear();
+			cpp::ConcatTo(&target, name, ":", id, ":", value, ":", ratio);
+			Keep(target);
+		});
+		cpp::MemoryWriter<char> writer;
+		runner.Run("concat/ConcatTo_MemoryWriter", bytes, [&] {
+			writer.clear();
+			cpp::ConcatTo(&writer, name, ":", id, ":", value, ":", ratio);
+			Keep(writer);
+		});
+		runner.Run("concat/wchar_t/Concat", bytes * sizeof(wchar_t), [&] { Keep(cpp::Concat<wchar_t>(in.wideShort, L":", id, L":", ratio)); });
+
+		runner.Run("join/baseline_ostringstream", bytes, [&] {
+			std::ostringstream stream;
+			stream << name << ',' << value << ',' << id << ',' << name;
+			Keep(stream.str());
+		});
+		runner.Run("join/Join_char", bytes, [&] { Keep(cpp::Join(',', name, value, id, name)); });
+		runner.Run("join/Join_string", bytes, [&] { Keep(cpp::Join(&", ", name, value, id, name)); });
+		runner.Run("join/JoinTo_MemoryWriter", bytes, [&] {
+			writer.clear();
+			cpp::JoinTo(&writer, ", ", name, value, id, name);
+			Keep(writer);
+		});
+		runner.Run("join/wchar_t/Join", bytes * sizeof(wchar_t), [&] { Keep(cpp::Join(L',', in.wideShort, id, in.wideShort)); });
+
+		runner.Run("memorywriter/append_small", bytes, [&] {
+			writer.clear();
+			writer.append(name.data(), name.size());
+			writer.push_back(':');
+			writer.append(value.data(), value.size());
+			Keep(writer);
+		});
+		runner.Run("memorywriter/append_spill", in.fewTokens.size(), [&] {
+			cpp::MemoryWriter<char> local;
+			local.append(in.fewTokens.data(), in.fewTokens.size());
+			Keep(local);
+		});
+	}
+
+	void BenchCsv(Runner& runner, const Inputs& in) {
+		const std::string& text = in.csv;
+		// what CSV import used before: a line at a time, split on ','; wrong on quoted fields.
+		runner.Run("csv/baseline_getline_SplitTrim", text.size(), [&] {
+			std::istringstream stream(text);
+			std::string line;
+			size_t total = 0;
+			while (std::getline(stream, line)) {
+				for (auto& field : cpp::SplitTrim(line, ',')) {
+					total += field.size();
+				}
+			}
+			Keep(total);
+		});
+		auto walk = [](const auto& view) {
+			std::string scratch;
+			size_t total = 0;
+			for (auto& row : view) {
+				for (auto field : row) {
+					total += field.value(&scratch).size();
+				}
+			}
+			return total;
+		};
+		runner.Run("csv/CsvView", text.size(), [&] { Keep(walk(cpp::CsvView(text))); });
+		runner.Run("csv/CsvView_AsciiSpace", text.size(), [&] { Keep(walk(cpp::CsvView<cpp::AsciiSpace>(text))); });
+		cpp::BasicCsvView<> view(text);
+		runner.Run("csv/CsvView_assign_reused", text.size(), [&] {
+			view.assign(text);
+			Keep(walk(view));
+		});
+		runner.Run("csv/CsvView_index_only", text.size(), [&] {
+			view.assign(text);
+			Keep(view);
+		});
+	}
+
+	void BenchReplace(Runner& runner, const Inputs& in) {
+		Random random;
+		std::vector<std::pair<std::string, std::string>> dictionary;
+		for (int i = 0; i < 2000; ++i) {
+			dictionary.emplace_back("user" + std::to_string(random(1000000)) + "@example.com", "<email>");
+		}
+		// a 64 KiB message with a needle every ~40 words.
+		std::string text;
+		while (text.size() < 64 * 1024) {
+			text += random(40) ? in.asciiText.substr(random(1024), 12) + " " : dictionary[random(2000)].first + " ";
+		}
+		runner.Run("replace/2000/baseline_find_replace", text.size(), [&] {
+			std::string result = text;
+			for (const auto& [needle, replacement] : dictionary) {
+				for (size_t pos = 0; (pos = result.find(needle, pos)) != std::string::npos; pos += replacement.size()) {
+					result.replace(pos, needle.size(), replacement);
+				}
+			}
+			Keep(result);
+		});
+		const cpp::MultiReplacer replacer(dictionary);
+		runner.Run("replace/2000/MultiReplacer", text.size(), [&] { Keep(replacer.ReplaceAll(text)); });
+		const cpp::MultiReplacer folded(dictionary, { true });
+		runner.Run("replace/2000/MultiReplacer_ignore_case", text.size(), [&] { Keep(folded.ReplaceAll(text)); });
+		// 2000 needles over 40 first bytes, more than the SSE2 prefilter takes.
+		std::vector<std::string> tags;
+		const std::string firsts = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789#$%&";
+		for (int i = 0; i < 2000; ++i) {
+			tags.push_back(firsts[i % firsts.size()] + std::to_string(random(1000000)));
+		}
+		const cpp::MultiMatcher tagged(tags);
+		runner.Run("replace/2000/MultiMatcher_FindAll_40_first_bytes", text.size(), [&] { Keep(tagged.FindAll(text)); });
+		const cpp::MultiMatcher sparse{ "password=", "token=" };
+		runner.Run("replace/2/MultiMatcher_Contains_prefiltered", text.size(), [&] { Keep(sparse.Contains(text)); });
+		runner.Run("replace/2/baseline_find", text.size(), [&] {
+			Keep(text.find("password=") != std::string::npos || text.find("token=") != std::string::npos);
+		});
+	}
+
+	void BenchParse(Runner& runner, const Inputs&) {
+		Random random;
+		// 4096 numbers, then 1024 "id,value,name" rows.
+		std::string numbers;
+		for (int i = 0; i < 4096; ++i) {
+			numbers += std::to_string(random(100000000)) + ',';
+		}
+		numbers.pop_back();
+		std::string decimals;
+		for (int i = 0; i < 4096; ++i) {
+			decimals += std::to_string(random(100000)) + '.' + std::to_string(random(1000)) + ',';
+		}
+		decimals.pop_back();
+		std::vector<std::string> rows;
+		size_t rowBytes{};
+		for (int i = 0; i < 1024; ++i) {
+			rows.push_back(std::to_string(random(1000000)) + ',' + std::to_string(random(1000)) + ".5,name" + std::to_string(i));
+			rowBytes += rows.back().size();
+		}
+		runner.Run("parse/int64/baseline_Split_stoll", numbers.size(), [&] {
+			std::vector<int64_t> values;
+			for (const auto& token : cpp::Split(numbers, ',')) {
+				values.push_back(std::stoll(token));
+			}
+			Keep(values);
+		});
+		std::vector<int64_t> ints;
+		runner.Run("parse/int64/SplitAs", numbers.size(), [&] {
+			ints.clear();
+			Keep(cpp::SplitAs<int64_t>(std::string_view(numbers), ',', &ints));
+			Keep(ints);
+		});
+		runner.Run("parse/double/baseline_Split_stod", decimals.size(), [&] {
+			std::vector<double> values;
+			for (const auto& token : cpp::Split(decimals, ',')) {
+				values.push_back(std::stod(token));
+			}
+			Keep(values);
+		});
+		std::vector<double> doubles;
+		runner.Run("parse/double/SplitAs", decimals.size(), [&] {
+			doubles.clear();
+			Keep(cpp::SplitAs<double>(std::string_view(decimals), ',', &doubles));
+			Keep(doubles);
+		});
+		runner.Run("parse/row/baseline_Split_stoi_stod", rowBytes, [&] {
+			for (const auto& row : rows) {
+				auto tokens = cpp::Split(row, ',');
+				Keep(std::make_tuple(std::stoi(tokens[0]), std::stod(tokens[1]), tokens[2]));
+			}
+		});
+		runner.Run("parse/row/ParseFields", rowBytes, [&] {
+			for (const auto& row : rows) {
+				Keep(cpp::ParseFields<int, double, std::string_view>(row, ','));
+			}
+		});
+	}
+
+	void BenchIntern(Runner& runner, const Inputs&) {
+		Random random;
+		// enum-like columns: status, host, method, repeated over ~64 KiB.
+		const char* statuses[] = { "200", "204", "301", "404", "500" };
+		const char* methods[] = { "GET", "POST", "PUT", "DELETE" };
+		std::string text;
+		while (text.size() < 64 * 1024) {
+			text += statuses[random(5)];
+			text += ",host-" + std::to_string(random(32)) + ".example.com,";
+			text += methods[random(4)];
+			text += ',';
+		}
+		text.pop_back();
+		std::vector<std::string> strings;
+		runner.Run("intern/baseline_Split_strings", text.size(), [&] {
+			strings.clear();
+			cpp::Split(text, ',', &strings);
+			Keep(strings);
+		});
+		cpp::StringPool<char> pool;
+		std::vector<uint32_t> ids;
+		runner.Run("intern/Split_StringPool_ids", text.size(), [&] {
+			ids.clear();
+			cpp::Split(text, ',', &pool, &ids);
+			Keep(ids);
+		});
+		cpp::ShardedStringPool<char> sharded;
+		runner.Run("intern/Split_ShardedStringPool_ids", text.size(), [&] {
+			ids.clear();
+			cpp::Split(text, ',', &sharded, &ids);
+			Keep(ids);
+		});
+		if (strings.empty() || ids.empty()) {
+			return;
+		}
+		// Footprint of one batch; strings up to 15 chars fit in the SSO buffer.
+		std::fprintf(runner.log, "# intern: %zu tokens, strings %zu bytes, ids + pool %zu bytes\n", ids.size(),
+			strings.capacity() * sizeof(std::string) + std::accumulate(strings.begin(), strings.end(), size_t{}, [](size_t sum, const std::string& token) {
+				return sum + (token.capacity() > 15 ? token.capacity() + 1 : 0);
+			}),
+			ids.capacity() * sizeof(uint32_t) + pool.memory_usage());
+	}
+
+	void BenchBatch(Runner& runner, const Inputs&) {
+		Random random;
+		// a column of 100k short, padded, mixed-case "key=Value;flag" cells.
+		std::vector<std::string> column;
+		size_t bytes{};
+		for (int i = 0; i < 100000; ++i) {
+			column.push_back(std::string(random(3), ' ') + "Key" + std::to_string(random(1000)) + "=Value;Flag" + std::string(random(3), ' '));
+			bytes += column.back().size();
+		}
+		const auto batch = cpp::StringBatch<char>::FromVector(column);
+		runner.Run("batch/FromVector", bytes, [&] { Keep(cpp::StringBatch<char>::FromVector(column)); });
+		runner.Run("batch/ToVector", bytes, [&] { Keep(batch.ToVector()); });
+		std::vector<std::string> strings;
+		runner.Run("batch/trim_lower/baseline_per_string", bytes, [&] {
+			strings = column;
+			for (auto& value : strings) {
+				cpp::Trim(&value);
+				cpp::ToLower(&value);
+			}
+			Keep(strings);
+		});
+		cpp::StringBatch<char> work;
+		runner.Run("batch/trim_lower/StringBatch", bytes, [&] {
+			work = batch;
+			cpp::Trim(&work);
+			cpp::ToLower(&work);
+			Keep(work);
+		});
+		runner.Run("batch/split/baseline_per_string", bytes, [&] {
+			size_t count{};
+			for (const auto& value : column) {
+				count += cpp::SplitTrim(value, "=;").size();
+			}
+			Keep(count);
+		});
+		cpp::StringBatch<char> tokens;
+		std::vector<size_t> rows;
+		runner.Run("batch/split/StringBatch", bytes, [&] {
+			tokens.clear();
+			rows.clear();
+			cpp::SplitTrim(batch, "=;", &tokens, &rows);
+			Keep(tokens);
+		});
+		runner.Run("batch/join/StringBatch", bytes, [&] { Keep(cpp::Join(batch, ',')); });
+	}
+
+	void BenchFixed(Runner& runner, const Inputs&) {
+		const std::string user = "request";
+		const int id = 421337;
+		const size_t bytes = 24;
+		runner.Run("fixed/static_key/baseline_Concat", bytes, [&] { Keep(cpp::Concat<char>("route:", "v", 2, "/users")); });
+		runner.Run("fixed/static_key/FixedString_constexpr", bytes, [&] {
+			static constexpr auto key = cpp::Concat(cpp::FixedString("route:"), "v", 2, "/users");
+			Keep(key);
+		});
+		runner.Run("fixed/runtime_key/baseline_Concat", bytes, [&] { Keep(cpp::Concat<char>("user:", user, ':', id)); });
+		runner.Run("fixed/runtime_key/FixedString_Bounded", bytes, [&] { Keep(cpp::Concat("user:", cpp::Bounded<32>(user), ':', id)); });
+		runner.Run("fixed/runtime_join/baseline_Join", bytes, [&] { Keep(cpp::Join('.', user, "v2", id)); });
+		runner.Run("fixed/runtime_join/FixedString_Bounded", bytes, [&] { Keep(cpp::Join('.', cpp::Bounded<32>(user), "v2", id)); });
+	}
+
+	void BenchFormat(Runner& runner, const Inputs& in) {
+		const std::string name = "request";
+		const int id = 421337;
+		const double ratio = 0.8125;
+		const size_t bytes = name.size() + in.shortLine.size();
+		runner.Run("format/baseline_snprintf", bytes, [&] {
+			char buffer[256];
+			int size = std::snprintf(buffer, sizeof(buffer), "user=%s id=%d ratio=%g line=%s", name.c_str(), id, ratio, in.shortLine.c_str());
+			Keep(std::string(buffer, size));
+		});
+		runner.Run("format/baseline_ostringstream", bytes, [&] {
+			std::ostringstream stream;
+			stream << "user=" << name << " id=" << id << " ratio=" << ratio << " line=" << in.shortLine;
+			Keep(stream.str());
+		});
+		runner.Run("format/Format_runtime", bytes, [&] { Keep(cpp::Format("user={} id={} ratio={} line={}", name, id, ratio, in.shortLine)); });
+		runner.Run("format/Format_CPP_FMT", bytes, [&] { Keep(cpp::Format(CPP_FMT("user={} id={} ratio={} line={}"), name, id, ratio, in.shortLine)); });
+		cpp::MemoryWriter<char> writer;
+		runner.Run("format/FormatTo_MemoryWriter", bytes, [&] {
+			writer.clear();
+			cpp::FormatTo(&writer, CPP_FMT("user={} id={} ratio={} line={}"), name, id, ratio, in.shortLine);
+			Keep(writer);
+		});
+		runner.Run("format/spec/baseline_snprintf", sizeof(double), [&] {
+			char buffer[64];
+			int size = std::snprintf(buffer, sizeof(buffer), "[%10.3f|%-8d|%08x]", ratio, id, id);
+			Keep(std::string(buffer, size));
+		});
+		runner.Run("format/spec/Format", sizeof(double), [&] { Keep(cpp::Format("[{:10.3f}|{:<8}|{:08x}]", ratio, id, id)); });
+		runner.Run("format/wchar_t/Format", bytes * sizeof(wchar_t), [&] { Keep(cpp::Format(L"user={} id={} line={}", in.wideShort, id, in.wideShort)); });
+	}
+}
+
+int main(int argc, char** argv) {
+	Runner runner;
+	const char* json = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc) {
+			runner.filter = argv[++i];
+		}
+		else if (arg == "--min-time" && i + 1 < argc) {
+			runner.minTime = std::atof(argv[++i]);
+		}
+		else if (arg == "--json" && i + 1 < argc) {
+			json = argv[++i];
+		}
+		else {
+			std::fprintf(stderr, "usage: %s [--filter <text>] [--min-time <seconds>] [--json <file>|-]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (json && std::string(json) == "-") {
+		runner.log = stderr;
+	}
+	const Inputs inputs;
+	BenchTrim(runner, inputs);
+	BenchSplit(runner, inputs);
+	BenchCase(runner, inputs);
+	BenchConcat(runner, inputs);
+	BenchCsv(runner, inputs);
+	BenchReplace(runner, inputs);
+	BenchParse(runner, inputs);
+	BenchIntern(runner, inputs);
+	BenchBatch(runner, inputs);
+	BenchFixed(runner, inputs);
+	BenchFormat(runner, inputs);
+
+	if constexpr (cpp::instrument::Enabled) {
+		std::string metrics;
+		cpp::instrument::WritePrometheus(cpp::instrument::Snapshot(), &metrics);
+		std::fputs(metrics.c_str(), stderr);
+	}
+	if (json) {
+		if (std::string(json) == "-") {
+			runner.WriteJson(std::cout);
+		}
+		else {
+			std::ofstream out(json);
+			runner.WriteJson(out);
+			if (!out) {
+				std::fprintf(stderr, "cannot write %s\n", json);
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
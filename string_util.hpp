@@ -1,495 +1,5147 @@
 #pragma once
 #include <string>
+#include <cctype>
+#include <cwctype>
+#include <string_view>
 #include <vector>
+#include <memory>
+#include <memory_resource>
+#include <iterator>
+#include <istream>
+#include <cerrno>
+#include <tuple>
+#include <utility>
 #include <cassert>
+#include <cstdint>
+#include <charconv>
+#include <array>
+#include <limits>
+#include <climits>
+#include <initializer_list>
+#include <cstring>
+#include <cmath>
 #include <algorithm>
 #include <functional>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#if !defined(STRING_UTIL_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define STRING_UTIL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+#if defined(_WIN32)
+#include <io.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define STRING_UTIL_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(STRING_UTIL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define STRING_UTIL_TARGET_AVX2 __attribute__((target("avx2")))
+#define STRING_UTIL_TARGET_PCLMUL __attribute__((target("pclmul,popcnt"), flatten))
+#define STRING_UTIL_TARGET_AVX2_PCLMUL __attribute__((target("avx2,pclmul,popcnt"), flatten))
+#else
+#define STRING_UTIL_TARGET_AVX2
+#define STRING_UTIL_TARGET_PCLMUL
+#define STRING_UTIL_TARGET_AVX2_PCLMUL
+#endif
 
 namespace cpp {
+	// -------------------------------------------------------------------
+	// Trim policies.
+	// -------------------------------------------------------------------
+	// Character classes for the Trim family and SplitTrim, e.g.
+	//   cpp::Trim<cpp::AsciiSpace>(&line);
+	// Contains() gets a code point; Utf8 makes char input decode as UTF-8.
+	struct SpaceOnly {
+		static constexpr bool Utf8 = false;
+		static constexpr bool Contains(char32_t ch) {
+			return ch == U' ';
+		}
+	};
+	struct AsciiSpace {
+		static constexpr bool Utf8 = false;
+		static constexpr bool Contains(char32_t ch) {
+			return ch == U' ' || (ch >= U'\t' && ch <= U'\r');
+		}
+	};
+	template<auto... _Chars>
+	struct SpaceSet {
+		static constexpr bool Utf8 = false;
+		static constexpr bool Contains(char32_t ch) {
+			return ((ch == static_cast<char32_t>(static_cast<std::make_unsigned_t<decltype(_Chars)>>(_Chars))) || ...);
+		}
+	};
+	// Unicode White_Space; char is read as UTF-8, char16_t/wchar_t per unit.
+	struct UnicodeSpace {
+		static constexpr bool Utf8 = true;
+		static constexpr bool Contains(char32_t ch) {
+			return ch == U' ' || (ch >= U'\t' && ch <= U'\r') || ch == 0x85 || ch == 0xA0 || ch == 0x1680
+				|| (ch >= 0x2000 && ch <= 0x200A) || ch == 0x2028 || ch == 0x2029 || ch == 0x202F || ch == 0x205F || ch == 0x3000;
+		}
+	};
+	// -------------------------------------------------------------------
+	// Instrumentation.
+	// -------------------------------------------------------------------
+	// Compiled in with STRING_UTIL_INSTRUMENT; otherwise every probe is an
+	// empty inline object and instrument::Snapshot() stays zero. Counters are
+	// thread-local and only merged when a snapshot is taken.
+#if defined(STRING_UTIL_INSTRUMENT)
+#define STRING_UTIL_INSTRUMENT_ENABLED 1
+#else
+#define STRING_UTIL_INSTRUMENT_ENABLED 0
+#endif
+	enum class StringApi : uint8_t {
+		Trim, TrimView, Split, SplitTrim, SplitAs, ParseFields, ParallelSplit, StreamSplit,
+		Csv, MultiMatch, MultiReplace, Intern, Batch, Case, Concat, Join, Format,
+		Count
+	};
+	struct ApiStats {
+		static constexpr size_t Latency_Buckets = 40;
+
+		uint64_t calls{};
+		uint64_t bytesIn{};			// elements read.
+		uint64_t bytesOut{};		// elements written.
+		uint64_t tokens{};			// tokens, matches or fields produced.
+		uint64_t allocations{};		// result buffers and strings that had to grow.
+		uint64_t growthBytes{};		// capacity added by those, in bytes.
+		uint64_t sampled{};			// calls timed, see instrument::SetLatencySampling.
+		uint64_t latency[Latency_Buckets]{};	// bucket i counts [2^i, 2^(i+1)) ns.
+	};
+	struct InstrumentSnapshot {
+		ApiStats apis[static_cast<size_t>(StringApi::Count)]{};
+
+		const ApiStats& operator[](StringApi api) const {
+			return apis[static_cast<size_t>(api)];
+		}
+	};
 	namespace detail {
-		// -------------------------------------------------------------------
-		// Shared Type.
-		// -------------------------------------------------------------------
-		template<typename _Elem>
-		struct Space_v {
-			static_assert(!std::_Is_character<_Elem>::value, "not support type.");
+		struct Atomic_Api_Stats {
+			std::atomic<uint64_t> calls{}, bytesIn{}, bytesOut{}, tokens{}, allocations{}, growthBytes{}, sampled{};
+			std::atomic<uint64_t> latency[ApiStats::Latency_Buckets]{};
 		};
-		template<>
-		struct Space_v<char> {
-			static const char value = ' ';
+		// Only the owning thread writes, so a relaxed load + store is enough
+		// and avoids a locked add on the hot path.
+		inline void Bump(std::atomic<uint64_t>& counter, uint64_t count) {
+			counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+		}
+		inline void Accumulate(const Atomic_Api_Stats& from, ApiStats* pto) {
+			auto& to = *pto;
+			to.calls += from.calls.load(std::memory_order_relaxed);
+			to.bytesIn += from.bytesIn.load(std::memory_order_relaxed);
+			to.bytesOut += from.bytesOut.load(std::memory_order_relaxed);
+			to.tokens += from.tokens.load(std::memory_order_relaxed);
+			to.allocations += from.allocations.load(std::memory_order_relaxed);
+			to.growthBytes += from.growthBytes.load(std::memory_order_relaxed);
+			to.sampled += from.sampled.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < ApiStats::Latency_Buckets; ++i) {
+				to.latency[i] += from.latency[i].load(std::memory_order_relaxed);
+			}
+		}
+		struct Thread_Counters;
+		struct Instrument_Registry {
+			std::mutex mutex;
+			std::vector<const Thread_Counters*> live;
+			InstrumentSnapshot retired;	// threads that already exited.
+			std::atomic<uint64_t> sampleMask{ 0 };	// 0: no timing.
 		};
-		template<>
-		struct Space_v<wchar_t> {
-			static const wchar_t value = L' ';
+		inline Instrument_Registry& GetInstrumentRegistry() {
+			static Instrument_Registry registry;
+			return registry;
+		}
+		struct Thread_Counters {
+			Atomic_Api_Stats apis[static_cast<size_t>(StringApi::Count)];
+			uint64_t tick{};
+
+			Thread_Counters() {
+				auto& registry = GetInstrumentRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				registry.live.push_back(this);
+			}
+			~Thread_Counters() {
+				auto& registry = GetInstrumentRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				for (size_t i = 0; i < static_cast<size_t>(StringApi::Count); ++i) {
+					Accumulate(apis[i], &registry.retired.apis[i]);
+				}
+				registry.live.erase(std::find(registry.live.begin(), registry.live.end(), this));
+			}
+		};
+		inline Thread_Counters& LocalCounters() {
+			thread_local Thread_Counters counters;
+			return counters;
+		}
+		// One probe per API call: counts on construction, adds the caller's
+		// figures as they are known and, when sampled, times the call.
+		class Probe {
+		public:
+			Probe(StringApi api, size_t bytesIn) {
+				auto& counters = LocalCounters();
+				stats = &counters.apis[static_cast<size_t>(api)];
+				Bump(stats->calls, 1);
+				Bump(stats->bytesIn, bytesIn);
+				auto mask = GetInstrumentRegistry().sampleMask.load(std::memory_order_relaxed);
+				if (mask && (++counters.tick & (mask - 1)) == 0) {
+					start = std::chrono::steady_clock::now();
+					timed = true;
+				}
+			}
+			Probe(const Probe&) = delete;
+			Probe& operator=(const Probe&) = delete;
+			~Probe() {
+				if (timed) {
+					auto nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+					size_t bucket{};
+					while (bucket + 1 < ApiStats::Latency_Buckets && (nanos >> (bucket + 1))) {
+						++bucket;
+					}
+					Bump(stats->sampled, 1);
+					Bump(stats->latency[bucket], 1);
+				}
+			}
+			// Input known only once the call has run, e.g. a stream.
+			void In(size_t count) {
+				Bump(stats->bytesIn, count);
+			}
+			void Out(size_t count) {
+				Bump(stats->bytesOut, count);
+			}
+			void Tokens(size_t count) {
+				Bump(stats->tokens, count);
+			}
+			void Allocs(size_t count) {
+				Bump(stats->allocations, count);
+			}
+			// Capacity in elements before and after the call.
+			void Grow(size_t before, size_t after, size_t elemSize) {
+				if (after > before) {
+					Bump(stats->allocations, 1);
+					Bump(stats->growthBytes, (after - before) * elemSize);
+				}
+			}
+			// A string built by the call; counts it if it left the inline buffer.
+			template<class _String>
+			void NewString(const _String& value) {
+				Bump(stats->bytesOut, value.size());
+				Grow(_String(value.get_allocator()).capacity(), value.capacity(), sizeof(typename _String::value_type));
+			}
+		private:
+			Atomic_Api_Stats* stats{};
+			std::chrono::steady_clock::time_point start{};
+			bool timed{};
+		};
+		struct Null_Probe {
+			constexpr Null_Probe(StringApi, size_t) {}
+			constexpr void In(size_t) const {}
+			constexpr void Out(size_t) const {}
+			constexpr void Tokens(size_t) const {}
+			constexpr void Allocs(size_t) const {}
+			constexpr void Grow(size_t, size_t, size_t) const {}
+			template<class _String>
+			constexpr void NewString(const _String&) const {}
 		};
+#if STRING_UTIL_INSTRUMENT_ENABLED
+		using Api_Probe = Probe;
+#else
+		using Api_Probe = Null_Probe;
+#endif
+	}
+	namespace instrument {
+		constexpr bool Enabled = STRING_UTIL_INSTRUMENT_ENABLED != 0;
+
+		inline const char* Name(StringApi api) {
+			static const char* names[] = { "trim", "trim_view", "split", "split_trim", "split_as", "parse_fields", "parallel_split", "stream_split",
+				"csv", "multi_match", "multi_replace", "intern", "batch", "case", "concat", "join", "format" };
+			static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(StringApi::Count), "missing api name.");
+			return names[static_cast<size_t>(api)];
+		}
+		// Times one call in every (rounded up to a power of two); 0 turns
+		// timing off, which is the default.
+		inline void SetLatencySampling(uint64_t every) {
+			uint64_t mask = every ? 1 : 0;
+			while (mask && mask < every) {
+				mask <<= 1;
+			}
+			detail::GetInstrumentRegistry().sampleMask.store(mask, std::memory_order_relaxed);
+		}
+		// Totals over all threads, live and exited, since the process started.
+		inline InstrumentSnapshot Snapshot() {
+			auto& registry = detail::GetInstrumentRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			InstrumentSnapshot snapshot = registry.retired;
+			for (auto counters : registry.live) {
+				for (size_t i = 0; i < static_cast<size_t>(StringApi::Count); ++i) {
+					detail::Accumulate(counters->apis[i], &snapshot.apis[i]);
+				}
+			}
+			return snapshot;
+		}
+		// Counters are never cleared under running writers; a scraper keeps the
+		// previous snapshot and reports Delta(current, previous) per interval.
+		inline InstrumentSnapshot Delta(const InstrumentSnapshot& later, const InstrumentSnapshot& earlier) {
+			InstrumentSnapshot delta{};
+			for (size_t i = 0; i < static_cast<size_t>(StringApi::Count); ++i) {
+				auto& to = delta.apis[i];
+				const auto& a = later.apis[i];
+				const auto& b = earlier.apis[i];
+				to.calls = a.calls - b.calls;
+				to.bytesIn = a.bytesIn - b.bytesIn;
+				to.bytesOut = a.bytesOut - b.bytesOut;
+				to.tokens = a.tokens - b.tokens;
+				to.allocations = a.allocations - b.allocations;
+				to.growthBytes = a.growthBytes - b.growthBytes;
+				to.sampled = a.sampled - b.sampled;
+				for (size_t bucket = 0; bucket < ApiStats::Latency_Buckets; ++bucket) {
+					to.latency[bucket] = a.latency[bucket] - b.latency[bucket];
+				}
+			}
+			return delta;
+		}
+		// Prometheus text exposition; APIs never called are skipped.
+		inline void WritePrometheus(const InstrumentSnapshot& snapshot, std::string* presult) {
+			assert(presult);
+			auto& lresult = *presult;
+			auto metric = [&](const char* name, const char* api, uint64_t value, const char* extra = nullptr) {
+				lresult += "string_util_";
+				lresult += name;
+				lresult += "{api=\"";
+				lresult += api;
+				lresult += '"';
+				if (extra) {
+					lresult += extra;
+				}
+				lresult += "} ";
+				lresult += std::to_string(value);
+				lresult += '\n';
+			};
+			for (size_t i = 0; i < static_cast<size_t>(StringApi::Count); ++i) {
+				const auto& stats = snapshot.apis[i];
+				if (!stats.calls) {
+					continue;
+				}
+				auto api = Name(static_cast<StringApi>(i));
+				metric("calls_total", api, stats.calls);
+				metric("bytes_in_total", api, stats.bytesIn);
+				metric("bytes_out_total", api, stats.bytesOut);
+				metric("tokens_total", api, stats.tokens);
+				metric("allocations_total", api, stats.allocations);
+				metric("growth_bytes_total", api, stats.growthBytes);
+				if (stats.sampled) {
+					uint64_t cumulative{};
+					for (size_t bucket = 0; bucket < ApiStats::Latency_Buckets; ++bucket) {
+						cumulative += stats.latency[bucket];
+						auto le = ",le=\"" + std::to_string(uint64_t(2) << bucket) + "\"";
+						metric("latency_ns_bucket", api, cumulative, le.c_str());
+					}
+					metric("latency_ns_bucket", api, cumulative, ",le=\"+Inf\"");
+					metric("latency_ns_count", api, stats.sampled);
+				}
+			}
+		}
+	}
+	namespace detail {
+		// -------------------------------------------------------------------
+		// Shared Type.
+		// -------------------------------------------------------------------
+		template<typename _Type>
+		constexpr bool Always_False_v = false;
 		template<typename _Elem>
 		struct To_Lower_Fn {
-			static_assert(!std::_Is_character<_Elem>::value, "not support type.");
+			static_assert(Always_False_v<_Elem>, "not support type.");
 		};
 		template<>
 		struct To_Lower_Fn<char> {
 			auto operator()(char ch) {
-				return std::tolower(ch);
+				return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
 			}
 		};
 		template<>
 		struct To_Lower_Fn<wchar_t> {
 			auto operator()(wchar_t ch) {
-				return towlower(ch);
+				return static_cast<wchar_t>(std::towlower(ch));
 			}
 		};
 		template<typename _Elem>
 		struct To_Upper_Fn {
-			static_assert(!std::_Is_character<_Elem>::value, "not support type.");
+			static_assert(Always_False_v<_Elem>, "not support type.");
 		};
 		template<>
 		struct To_Upper_Fn<char> {
 			auto operator()(char ch) {
-				return std::toupper(ch);
+				return static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+			}
+		};
+		template<>
+		struct To_Upper_Fn<wchar_t> {
+			auto operator()(wchar_t ch) {
+				return static_cast<wchar_t>(std::towupper(ch));
+			}
+		};
+		// -------------------------------------------------------------------
+		// Whitespace.
+		// -------------------------------------------------------------------
+		// A trim policy has a static Utf8 flag and Contains(char32_t).
+		template<class _Policy, class = void>
+		struct Is_Trim_Policy : std::false_type {};
+		template<class _Policy>
+		struct Is_Trim_Policy<_Policy, std::void_t<decltype(bool{ _Policy::Utf8 }), decltype(bool{ _Policy::Contains(char32_t{}) })>> : std::true_type {};
+		template<class _Policy>
+		using Enable_If_Policy_t = std::enable_if_t<Is_Trim_Policy<_Policy>::value, int>;
+		// Blocks deduction, so that a parameter is only set explicitly.
+		template<class _Type>
+		struct Type_Identity {
+			using type = _Type;
+		};
+		template<class _Type>
+		using Type_Identity_t = typename Type_Identity<_Type>::type;
+		// One lookup per element below 256; wider code units ask the policy.
+		template<class _Policy>
+		struct Space_Table {
+			bool value[256]{};
+			constexpr Space_Table() {
+				for (char32_t i = 0; i < 256; ++i) {
+					value[i] = _Policy::Contains(i);
+				}
+			}
+		};
+		template<class _Policy>
+		constexpr Space_Table<_Policy> Space_Table_v{};
+		template<class _Policy, class _Elem>
+		constexpr bool IsSpace(_Elem ch) {
+			const auto code = static_cast<std::make_unsigned_t<_Elem>>(ch);
+			return code < 256 ? Space_Table_v<_Policy>.value[code] : _Policy::Contains(code);
+		}
+		template<class _Policy, class _Elem>
+		constexpr bool Is_Utf8_Space_v = _Policy::Utf8 && sizeof(_Elem) == 1;
+		// Length of a 2 or 3 byte space sequence at src, 0 if there is none.
+		template<class _Policy, class _Byte>
+		constexpr size_t Utf8SpaceAt(const _Byte* src, size_t size) {
+			const auto byte = [src](size_t i) { return static_cast<unsigned char>(src[i]); };
+			if (size >= 2 && (byte(0) & 0xE0) == 0xC0 && (byte(1) & 0xC0) == 0x80) {
+				return _Policy::Contains(char32_t(byte(0) & 0x1F) << 6 | (byte(1) & 0x3F)) ? 2 : 0;
+			}
+			if (size >= 3 && (byte(0) & 0xF0) == 0xE0 && (byte(1) & 0xC0) == 0x80 && (byte(2) & 0xC0) == 0x80) {
+				return _Policy::Contains(char32_t(byte(0) & 0x0F) << 12 | char32_t(byte(1) & 0x3F) << 6 | (byte(2) & 0x3F)) ? 3 : 0;
+			}
+			return 0;
+		}
+		// Number of leading elements in the class; constexpr for FixedString.
+		template<class _Policy, class _Elem>
+		constexpr size_t SpacePrefix(const _Elem* src, size_t size) {
+			size_t pos = 0;
+			if constexpr (Is_Utf8_Space_v<_Policy, _Elem>) {
+				while (pos < size) {
+					const auto byte = static_cast<unsigned char>(src[pos]);
+					if (byte < 0x80) {
+						if (!Space_Table_v<_Policy>.value[byte]) {
+							break;
+						}
+						++pos;
+						continue;
+					}
+					auto length = Utf8SpaceAt<_Policy>(src + pos, size - pos);
+					if (length == 0) {
+						break;
+					}
+					pos += length;
+				}
+			}
+			else {
+				while (pos < size && IsSpace<_Policy>(src[pos])) {
+					++pos;
+				}
+			}
+			return pos;
+		}
+		// Size left once trailing elements in the class are dropped.
+		template<class _Policy, class _Elem>
+		constexpr size_t SpaceEnd(const _Elem* src, size_t size) {
+			if constexpr (Is_Utf8_Space_v<_Policy, _Elem>) {
+				while (size) {
+					const auto byte = static_cast<unsigned char>(src[size - 1]);
+					if (byte < 0x80) {
+						if (!Space_Table_v<_Policy>.value[byte]) {
+							break;
+						}
+						--size;
+					}
+					else if (size >= 2 && Utf8SpaceAt<_Policy>(src + size - 2, 2) == 2) {
+						size -= 2;
+					}
+					else if (size >= 3 && Utf8SpaceAt<_Policy>(src + size - 3, 3) == 3) {
+						size -= 3;
+					}
+					else {
+						break;
+					}
+				}
+			}
+			else {
+				while (size && IsSpace<_Policy>(src[size - 1])) {
+					--size;
+				}
+			}
+			return size;
+		}
+		// -------------------------------------------------------------------
+		// Delimiter.
+		// -------------------------------------------------------------------
+		enum class SimdLevel {
+			Scalar,
+			Sse2,
+			Avx2,
+		};
+		inline SimdLevel DetectSimdLevel() {
+#if defined(STRING_UTIL_X86)
+#if defined(_MSC_VER)
+			int info[4]{};
+			__cpuid(info, 0);
+			if (info[0] >= 7) {
+				__cpuid(info, 1);
+				bool osxsave = (info[2] & (1 << 27)) != 0;
+				bool avx = (info[2] & (1 << 28)) != 0;
+				if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+					__cpuidex(info, 7, 0);
+					if (info[1] & (1 << 5)) {
+						return SimdLevel::Avx2;
+					}
+				}
+			}
+#else
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2")) {
+				return SimdLevel::Avx2;
+			}
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+			return SimdLevel::Sse2;
+#endif
+#endif
+			return SimdLevel::Scalar;
+		}
+		inline SimdLevel CurrentSimdLevel() {
+			static const SimdLevel level = DetectSimdLevel();
+			return level;
+		}
+		// 256-entry character class bitmap.
+		struct Char_Class_Map {
+			uint8_t bits[32];
+
+			void Set(unsigned char ch) {
+				bits[ch >> 3] |= static_cast<uint8_t>(1u << (ch & 7));
+			}
+			bool Test(unsigned char ch) const {
+				return (bits[ch >> 3] >> (ch & 7)) & 1u;
+			}
+		};
+		// Finds the first byte of a delimiter set; the kernel is picked once per scanner.
+		struct Byte_Scanner {
+			Char_Class_Map map{};
+			unsigned char chars[16]{};
+			size_t count{};
+			// nibble tables for the AVX2 kernel: bit (hi & 7) of table[lo], split on hi < 8.
+			uint8_t lowTable[16]{};
+			uint8_t highTable[16]{};
+			const char* (*kernel)(const Byte_Scanner&, const char*, const char*){};
+			const char* (*collector)(const Byte_Scanner&, const char*, const char*, const char**, size_t*){};
+
+			Byte_Scanner(const char* delim, size_t length, SimdLevel level = CurrentSimdLevel()) {
+				size_t distinct{};
+				for (size_t i = 0; i < length; ++i) {
+					auto ch = static_cast<unsigned char>(delim[i]);
+					if (map.Test(ch)) {
+						continue;
+					}
+					map.Set(ch);
+					if (distinct < sizeof(chars)) {
+						chars[distinct] = ch;
+					}
+					++distinct;
+					if (ch < 0x80) {
+						lowTable[ch & 0xF] |= static_cast<uint8_t>(1u << (ch >> 4));
+					}
+					else {
+						highTable[ch & 0xF] |= static_cast<uint8_t>(1u << ((ch >> 4) - 8));
+					}
+				}
+				count = distinct;
+				kernel = &ScanScalar;
+				collector = &CollectScalar;
+#if defined(STRING_UTIL_X86)
+				if (level == SimdLevel::Avx2) {
+					kernel = &ScanAvx2;
+					collector = &CollectAvx2;
+				}
+				else if (level == SimdLevel::Sse2 && count <= sizeof(chars)) {
+					kernel = &ScanSse2;
+					collector = &CollectSse2;
+				}
+#else
+				(void)level;
+#endif
+			}
+			const char* operator()(const char* first, const char* last) const {
+				return kernel(*this, first, last);
+			}
+			// Appends delimiter positions to out (room for at least Collect_Capacity)
+			// a block at a time; returns where scanning stopped.
+			static constexpr size_t Collect_Capacity = 128;
+			const char* Collect(const char* first, const char* last, const char** out, size_t* pcount) const {
+				return collector(*this, first, last, out, pcount);
+			}
+
+			static const char* ScanScalar(const Byte_Scanner& scanner, const char* first, const char* last) {
+				for (; first != last; ++first) {
+					if (scanner.map.Test(static_cast<unsigned char>(*first))) {
+						return first;
+					}
+				}
+				return last;
+			}
+			static const char* CollectScalar(const Byte_Scanner& scanner, const char* first, const char* last, const char** out, size_t* pcount) {
+				auto count = *pcount;
+				for (; first != last && count < Collect_Capacity; ++first) {
+					if (scanner.map.Test(static_cast<unsigned char>(*first))) {
+						out[count++] = first;
+					}
+				}
+				*pcount = count;
+				return first;
+			}
+#if defined(STRING_UTIL_X86)
+			static void EmitBits(const char* block, unsigned mask, const char** out, size_t* pcount) {
+				auto count = *pcount;
+				while (mask) {
+					out[count++] = block + FirstBit(mask);
+					mask &= mask - 1;
+				}
+				*pcount = count;
+			}
+			static int FirstBit(unsigned mask) {
+#if defined(_MSC_VER)
+				unsigned long index;
+				_BitScanForward(&index, mask);
+				return static_cast<int>(index);
+#else
+				return __builtin_ctz(mask);
+#endif
+			}
+			struct Sse2_Matcher {
+				__m128i needles[sizeof(chars)];
+				size_t count;
+
+				explicit Sse2_Matcher(const Byte_Scanner& scanner) : count(scanner.count) {
+					for (size_t i = 0; i < count; ++i) {
+						needles[i] = _mm_set1_epi8(static_cast<char>(scanner.chars[i]));
+					}
+				}
+				unsigned operator()(const char* first) const {
+					__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+					__m128i hits = _mm_setzero_si128();
+					for (size_t i = 0; i < count; ++i) {
+						hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[i]));
+					}
+					return static_cast<unsigned>(_mm_movemask_epi8(hits));
+				}
+			};
+			// Small sets compare against each byte; larger ones, and the empty set
+			// whose needles would be NUL, use the nibble tables.
+			struct Avx2_Matcher {
+				__m256i needles[4];
+				__m256i lowTable;
+				__m256i highTable;
+				bool small;
+
+				STRING_UTIL_TARGET_AVX2
+				explicit Avx2_Matcher(const Byte_Scanner& scanner) : small(scanner.count != 0 && scanner.count <= 4) {
+					for (size_t i = 0; i < 4; ++i) {
+						needles[i] = _mm256_set1_epi8(static_cast<char>(scanner.chars[i < scanner.count ? i : 0]));
+					}
+					lowTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(scanner.lowTable)));
+					highTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(scanner.highTable)));
+				}
+				STRING_UTIL_TARGET_AVX2
+				unsigned operator()(const char* first) const {
+					__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+					if (small) {
+						__m256i hits = _mm256_or_si256(
+							_mm256_or_si256(_mm256_cmpeq_epi8(block, needles[0]), _mm256_cmpeq_epi8(block, needles[1])),
+							_mm256_or_si256(_mm256_cmpeq_epi8(block, needles[2]), _mm256_cmpeq_epi8(block, needles[3])));
+						return static_cast<unsigned>(_mm256_movemask_epi8(hits));
+					}
+					const __m256i bit_table = _mm256_setr_epi8(
+						1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+						1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+					const __m256i nibble = _mm256_set1_epi8(0x0F);
+					__m256i lo = _mm256_and_si256(block, nibble);
+					__m256i hi = _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble);
+					__m256i bit = _mm256_shuffle_epi8(bit_table, hi);
+					__m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(lowTable, lo), _mm256_shuffle_epi8(highTable, lo), block);
+					__m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), _mm256_setzero_si256());
+					return ~static_cast<unsigned>(_mm256_movemask_epi8(miss));
+				}
+			};
+			static const char* ScanSse2(const Byte_Scanner& scanner, const char* first, const char* last) {
+				Sse2_Matcher matcher(scanner);
+				for (; last - first >= 16; first += 16) {
+					if (auto mask = matcher(first)) {
+						return first + FirstBit(mask);
+					}
+				}
+				return ScanScalar(scanner, first, last);
+			}
+			static const char* CollectSse2(const Byte_Scanner& scanner, const char* first, const char* last, const char** out, size_t* pcount) {
+				Sse2_Matcher matcher(scanner);
+				for (; last - first >= 16 && *pcount <= Collect_Capacity - 16; first += 16) {
+					EmitBits(first, matcher(first), out, pcount);
+				}
+				if (last - first >= 16) {
+					return first;
+				}
+				return CollectScalar(scanner, first, last, out, pcount);
+			}
+			STRING_UTIL_TARGET_AVX2
+			static const char* ScanAvx2(const Byte_Scanner& scanner, const char* first, const char* last) {
+				Avx2_Matcher matcher(scanner);
+				for (; last - first >= 32; first += 32) {
+					if (auto mask = matcher(first)) {
+						return first + FirstBit(mask);
+					}
+				}
+				return ScanScalar(scanner, first, last);
+			}
+			STRING_UTIL_TARGET_AVX2
+			static const char* CollectAvx2(const Byte_Scanner& scanner, const char* first, const char* last, const char** out, size_t* pcount) {
+				Avx2_Matcher matcher(scanner);
+				for (; last - first >= 32 && *pcount <= Collect_Capacity - 32; first += 32) {
+					EmitBits(first, matcher(first), out, pcount);
+				}
+				if (last - first >= 32) {
+					return first;
+				}
+				return CollectScalar(scanner, first, last, out, pcount);
+			}
+#endif
+		};
+		template<class _Elem, class _Traits>
+		constexpr bool Is_Byte_Scan_v = std::is_same<_Elem, char>::value && std::is_same<_Traits, std::char_traits<char>>::value;
+
+		template<class _Elem, class _Traits = std::char_traits<_Elem>, bool = Is_Byte_Scan_v<_Elem, _Traits>>
+		struct Char_Delim_Fn {
+			_Elem delim;
+			explicit Char_Delim_Fn(_Elem delim) : delim(delim) {}
+			const _Elem* operator()(const _Elem* first, const _Elem* last) const {
+				auto found = _Traits::find(first, static_cast<size_t>(last - first), delim);
+				return found ? found : last;
+			}
+		};
+		template<class _Elem, class _Traits = std::char_traits<_Elem>, bool = Is_Byte_Scan_v<_Elem, _Traits>>
+		struct Set_Delim_Fn {
+			const _Elem* delim;
+			size_t count;
+			explicit Set_Delim_Fn(const _Elem* delim) : delim(delim), count(_Traits::length(delim)) {}
+			const _Elem* operator()(const _Elem* first, const _Elem* last) const {
+				for (; first != last; ++first) {
+					if (_Traits::find(delim, count, *first)) {
+						return first;
+					}
+				}
+				return last;
+			}
+		};
+		template<class _Traits>
+		struct Char_Delim_Fn<char, _Traits, true> {
+			Byte_Scanner scanner;
+			explicit Char_Delim_Fn(char delim) : scanner(&delim, 1) {}
+			const char* operator()(const char* first, const char* last) const {
+				return scanner(first, last);
+			}
+		};
+		template<class _Traits>
+		struct Set_Delim_Fn<char, _Traits, true> {
+			Byte_Scanner scanner;
+			explicit Set_Delim_Fn(const char* delim) : scanner(delim, _Traits::length(delim)) {}
+			const char* operator()(const char* first, const char* last) const {
+				return scanner(first, last);
+			}
+		};
+		template<class _Policy, class _Elem, class _Traits>
+		inline auto TrimToken(std::basic_string_view<_Elem, _Traits> token) {
+			auto last = SpaceEnd<_Policy>(token.data(), token.size());
+			auto first = SpacePrefix<_Policy>(token.data(), last);
+			return token.substr(first, last - first);
+		}
+		template<class _Trim, class _Elem, class _Traits, class _Fn>
+		inline void EmitToken(const _Elem* first, const _Elem* last, _Fn& callback) {
+			std::basic_string_view<_Elem, _Traits> token(first, static_cast<size_t>(last - first));
+			if constexpr (!std::is_void<_Trim>::value) {
+				callback(TrimToken<_Trim>(token));
+			}
+			else {
+				callback(token);
+			}
+		}
+		template<class _Trim, class _Traits, class _Fn>
+		inline void ForEachByteToken(std::basic_string_view<char, _Traits> rstring, const Byte_Scanner& scanner, _Fn&& callback) {
+			const char* positions[Byte_Scanner::Collect_Capacity];
+			auto first = rstring.data();
+			auto scan = first;
+			const auto last = first + rstring.size();
+			while (scan != last) {
+				size_t count{};
+				scan = scanner.Collect(scan, last, positions, &count);
+				for (size_t i = 0; i < count; ++i) {
+					EmitToken<_Trim, char, _Traits>(first, positions[i], callback);
+					first = positions[i] + 1;
+				}
+			}
+			EmitToken<_Trim, char, _Traits>(first, last, callback);
+		}
+		template<class _Trim, class _Elem, class _Traits, class _DelimFn, class _Fn>
+		inline void ForEachToken(std::basic_string_view<_Elem, _Traits> rstring, const _DelimFn& fn, _Fn&& callback) {
+			if constexpr (Is_Byte_Scan_v<_Elem, _Traits>) {
+				ForEachByteToken<_Trim>(rstring, fn.scanner, callback);
+			}
+			else {
+				auto first = rstring.data();
+				const auto last = first + rstring.size();
+				while (true) {
+					auto delim = fn(first, last);
+					EmitToken<_Trim, _Elem, _Traits>(first, delim, callback);
+					if (delim == last) {
+						break;
+					}
+					first = delim + 1;
+				}
+			}
+		}
+		// -------------------------------------------------------------------
+		// Case.
+		// -------------------------------------------------------------------
+		// Converts the ASCII prefix of src into dst (dst <= src is allowed) and
+		// returns its length; stops at the first byte >= 0x80.
+		inline size_t CaseAsciiScalar(const char* src, char* dst, size_t size, bool upper) {
+			const char first = upper ? 'a' : 'A';
+			size_t i{};
+			for (; i < size; ++i) {
+				auto ch = static_cast<unsigned char>(src[i]);
+				if (ch >= 0x80) {
+					break;
+				}
+				dst[i] = static_cast<char>(static_cast<unsigned char>(ch - first) < 26 ? ch ^ 0x20 : ch);
+			}
+			return i;
+		}
+#if defined(STRING_UTIL_X86)
+		inline size_t CaseAsciiSse2(const char* src, char* dst, size_t size, bool upper) {
+			const __m128i below = _mm_set1_epi8(upper ? 'a' - 1 : 'A' - 1);
+			const __m128i above = _mm_set1_epi8(upper ? 'z' + 1 : 'Z' + 1);
+			const __m128i flip = _mm_set1_epi8(0x20);
+			size_t i{};
+			for (; i + 16 <= size; i += 16) {
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				if (_mm_movemask_epi8(block)) {
+					break;
+				}
+				__m128i letter = _mm_and_si128(_mm_cmpgt_epi8(block, below), _mm_cmplt_epi8(block, above));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(block, _mm_and_si128(letter, flip)));
+			}
+			return i + CaseAsciiScalar(src + i, dst + i, size - i, upper);
+		}
+		STRING_UTIL_TARGET_AVX2
+		inline size_t CaseAsciiAvx2(const char* src, char* dst, size_t size, bool upper) {
+			const __m256i below = _mm256_set1_epi8(upper ? 'a' - 1 : 'A' - 1);
+			const __m256i above = _mm256_set1_epi8(upper ? 'z' + 1 : 'Z' + 1);
+			const __m256i flip = _mm256_set1_epi8(0x20);
+			size_t i{};
+			for (; i + 32 <= size; i += 32) {
+				__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				if (_mm256_movemask_epi8(block)) {
+					break;
+				}
+				__m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(block, below), _mm256_cmpgt_epi8(above, block));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(block, _mm256_and_si256(letter, flip)));
+			}
+			return i + CaseAsciiScalar(src + i, dst + i, size - i, upper);
+		}
+#endif
+		inline size_t CaseAscii(const char* src, char* dst, size_t size, bool upper) {
+#if defined(STRING_UTIL_X86)
+			switch (CurrentSimdLevel()) {
+			case SimdLevel::Avx2:
+				return CaseAsciiAvx2(src, dst, size, upper);
+			case SimdLevel::Sse2:
+				return CaseAsciiSse2(src, dst, size, upper);
+			default:
+				break;
+			}
+#endif
+			return CaseAsciiScalar(src, dst, size, upper);
+		}
+		// ASCII runs go through the kernel, other bytes through the locale.
+		template<class _Fn>
+		inline void CaseBytes(const char* src, char* dst, size_t size, bool upper, _Fn fn) {
+			size_t i{};
+			while (i < size) {
+				i += CaseAscii(src + i, dst + i, size - i, upper);
+				if (i < size) {
+					dst[i] = fn(src[i]);
+					++i;
+				}
+			}
+		}
+		// Simple case mapping for the cased scripts in the BMP, as
+		// {first, last, delta, stride}; stride 2 maps every other code point.
+		struct Case_Range {
+			uint32_t first;
+			uint32_t last;
+			int32_t delta;
+			uint32_t stride;
+		};
+		constexpr Case_Range Lower_Case_Table[] = {
+			{ 0x41, 0x5A, 32, 1 }, { 0xC0, 0xD6, 32, 1 }, { 0xD8, 0xDE, 32, 1 },
+			{ 0x100, 0x12E, 1, 2 }, { 0x130, 0x130, -199, 1 }, { 0x132, 0x136, 1, 2 },
+			{ 0x139, 0x147, 1, 2 }, { 0x14A, 0x176, 1, 2 }, { 0x178, 0x178, -121, 1 },
+			{ 0x179, 0x17D, 1, 2 }, { 0x386, 0x386, 38, 1 }, { 0x388, 0x38A, 37, 1 },
+			{ 0x38C, 0x38C, 64, 1 }, { 0x38E, 0x38F, 63, 1 }, { 0x391, 0x3A1, 32, 1 },
+			{ 0x3A3, 0x3AB, 32, 1 }, { 0x3D8, 0x3EE, 1, 2 }, { 0x400, 0x40F, 80, 1 },
+			{ 0x410, 0x42F, 32, 1 }, { 0x460, 0x480, 1, 2 }, { 0x48A, 0x4BE, 1, 2 },
+			{ 0x4C0, 0x4C0, 15, 1 }, { 0x4C1, 0x4CD, 1, 2 }, { 0x4D0, 0x52E, 1, 2 },
+			{ 0x531, 0x556, 48, 1 }, { 0x10A0, 0x10C5, 7264, 1 }, { 0x1E00, 0x1E94, 1, 2 },
+			{ 0x1E9E, 0x1E9E, -7615, 1 }, { 0x1EA0, 0x1EFE, 1, 2 }, { 0x2160, 0x216F, 16, 1 },
+			{ 0x24B6, 0x24CF, 26, 1 }, { 0x2C00, 0x2C2E, 48, 1 }, { 0xFF21, 0xFF3A, 32, 1 },
+		};
+		constexpr Case_Range Upper_Case_Table[] = {
+			{ 0x61, 0x7A, -32, 1 }, { 0xB5, 0xB5, 743, 1 }, { 0xE0, 0xF6, -32, 1 },
+			{ 0xF8, 0xFE, -32, 1 }, { 0xFF, 0xFF, 121, 1 }, { 0x101, 0x12F, -1, 2 },
+			{ 0x131, 0x131, -232, 1 }, { 0x133, 0x137, -1, 2 }, { 0x13A, 0x148, -1, 2 },
+			{ 0x14B, 0x177, -1, 2 }, { 0x17A, 0x17E, -1, 2 }, { 0x17F, 0x17F, -300, 1 },
+			{ 0x3AC, 0x3AC, -38, 1 }, { 0x3AD, 0x3AF, -37, 1 }, { 0x3B1, 0x3C1, -32, 1 },
+			{ 0x3C2, 0x3C2, -31, 1 }, { 0x3C3, 0x3CB, -32, 1 }, { 0x3CC, 0x3CC, -64, 1 },
+			{ 0x3CD, 0x3CE, -63, 1 }, { 0x3D9, 0x3EF, -1, 2 }, { 0x430, 0x44F, -32, 1 },
+			{ 0x450, 0x45F, -80, 1 }, { 0x461, 0x481, -1, 2 }, { 0x48B, 0x4BF, -1, 2 },
+			{ 0x4C2, 0x4CE, -1, 2 }, { 0x4CF, 0x4CF, -15, 1 }, { 0x4D1, 0x52F, -1, 2 },
+			{ 0x561, 0x586, -48, 1 }, { 0x1E01, 0x1E95, -1, 2 }, { 0x1EA1, 0x1EFF, -1, 2 },
+			{ 0x2170, 0x217F, -16, 1 }, { 0x24D0, 0x24E9, -26, 1 }, { 0x2C30, 0x2C5E, -48, 1 },
+			{ 0x2D00, 0x2D25, -7264, 1 }, { 0xFF41, 0xFF5A, -32, 1 },
+		};
+		constexpr size_t Utf8Length(uint32_t cp) {
+			return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+		}
+		// Mapping never lengthens a sequence, so UTF-8 case conversion can run in place.
+		template<size_t _Size>
+		constexpr bool IsCaseTableValid(const Case_Range(&table)[_Size]) {
+			for (size_t i = 0; i < _Size; ++i) {
+				if ((i && table[i - 1].last >= table[i].first)
+					|| Utf8Length(static_cast<uint32_t>(static_cast<int32_t>(table[i].first) + table[i].delta)) > Utf8Length(table[i].first)
+					|| Utf8Length(static_cast<uint32_t>(static_cast<int32_t>(table[i].last) + table[i].delta)) > Utf8Length(table[i].last)) {
+					return false;
+				}
+			}
+			return true;
+		}
+		static_assert(IsCaseTableValid(Lower_Case_Table), "lower case table must be sorted and not lengthen UTF-8.");
+		static_assert(IsCaseTableValid(Upper_Case_Table), "upper case table must be sorted and not lengthen UTF-8.");
+
+		template<size_t _Size>
+		inline uint32_t MapCase(const Case_Range(&table)[_Size], uint32_t cp) {
+			auto range = std::upper_bound(std::begin(table), std::end(table), cp, [](uint32_t value, const Case_Range& entry) {
+				return value < entry.first;
+			});
+			if (range == std::begin(table)) {
+				return cp;
+			}
+			--range;
+			if (cp > range->last || (cp - range->first) % range->stride) {
+				return cp;
+			}
+			return static_cast<uint32_t>(static_cast<int32_t>(cp) + range->delta);
+		}
+		// Decodes one sequence at src; returns its length, or 0 when it is malformed.
+		inline size_t DecodeUtf8(const unsigned char* src, size_t size, uint32_t* pcp) {
+			const auto lead = src[0];
+			size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+			if (length == 0 || length > size || lead >= 0xF8) {
+				return 0;
+			}
+			uint32_t cp = lead & (0x7F >> length);
+			for (size_t i = 1; i < length; ++i) {
+				if ((src[i] & 0xC0) != 0x80) {
+					return 0;
+				}
+				cp = (cp << 6) | (src[i] & 0x3F);
+			}
+			if (Utf8Length(cp) != length) {
+				return 0;
+			}
+			*pcp = cp;
+			return length;
+		}
+		inline size_t EncodeUtf8(uint32_t cp, char* dst) {
+			if (cp < 0x80) {
+				dst[0] = static_cast<char>(cp);
+				return 1;
+			}
+			if (cp < 0x800) {
+				dst[0] = static_cast<char>(0xC0 | (cp >> 6));
+				dst[1] = static_cast<char>(0x80 | (cp & 0x3F));
+				return 2;
+			}
+			if (cp < 0x10000) {
+				dst[0] = static_cast<char>(0xE0 | (cp >> 12));
+				dst[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+				dst[2] = static_cast<char>(0x80 | (cp & 0x3F));
+				return 3;
+			}
+			dst[0] = static_cast<char>(0xF0 | (cp >> 18));
+			dst[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+			dst[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			dst[3] = static_cast<char>(0x80 | (cp & 0x3F));
+			return 4;
+		}
+		// Returns the converted length, which is never more than size.
+		// Malformed bytes are copied through unchanged.
+		inline size_t CaseUtf8(const char* src, char* dst, size_t size, bool upper) {
+			size_t read{}, written{};
+			while (read < size) {
+				auto ascii = CaseAscii(src + read, dst + written, size - read, upper);
+				read += ascii;
+				written += ascii;
+				if (read == size) {
+					break;
+				}
+				uint32_t cp{};
+				auto length = DecodeUtf8(reinterpret_cast<const unsigned char*>(src + read), size - read, &cp);
+				if (length == 0) {
+					dst[written++] = src[read++];
+					continue;
+				}
+				cp = upper ? MapCase(Upper_Case_Table, cp) : MapCase(Lower_Case_Table, cp);
+				read += length;
+				written += EncodeUtf8(cp, dst + written);
+			}
+			return written;
+		}
+		template<class _Elem, class _Traits, class _Alloc, class _Fn>
+		inline void CaseInPlace(std::basic_string<_Elem, _Traits, _Alloc>* pstring, bool upper, _Fn fn) {
+			auto& lstring = *pstring;
+			if constexpr (Is_Byte_Scan_v<_Elem, _Traits>) {
+				CaseBytes(lstring.data(), lstring.data(), lstring.size(), upper, fn);
+			}
+			else {
+				std::transform(lstring.begin(), lstring.end(), lstring.begin(), fn);
+			}
+		}
+		// -------------------------------------------------------------------
+		// Arg Parsing.
+		// -------------------------------------------------------------------
+		// Arguments are measured first, then written straight into the
+		// reserved output; numbers go through a stack buffer.
+		template<typename _Arg>
+		constexpr bool Is_Char_Type_v = std::is_same<_Arg, char>::value || std::is_same<_Arg, wchar_t>::value
+			|| std::is_same<_Arg, char16_t>::value || std::is_same<_Arg, char32_t>::value
+#if defined(__cpp_char8_t)
+			|| std::is_same<_Arg, char8_t>::value
+#endif
+			;
+		template<typename _Elem>
+		struct Pointer_Out {
+			_Elem* pos;
+
+			void Append(const _Elem* str, size_t size) {
+				std::copy(str, str + size, pos);
+				pos += size;
+			}
+			void AppendNarrow(const char* str, size_t size) {
+				for (size_t i = 0; i < size; ++i) {
+					*pos++ = static_cast<_Elem>(str[i]);
+				}
+			}
+			void Put(_Elem ch) {
+				*pos++ = ch;
+			}
+		};
+		template<typename _Elem, class _OutIt>
+		struct Iterator_Out {
+			_OutIt it;
+			size_t count;
+
+			void Append(const _Elem* str, size_t size) {
+				it = std::copy(str, str + size, it);
+				count += size;
+			}
+			void AppendNarrow(const char* str, size_t size) {
+				for (size_t i = 0; i < size; ++i) {
+					*it++ = static_cast<_Elem>(str[i]);
+				}
+				count += size;
+			}
+			void Put(_Elem ch) {
+				*it++ = ch;
+				++count;
+			}
+		};
+		// "{:[[fill]align][sign][#][0][width][.precision][type]}".
+		struct Format_Spec {
+			uint32_t fill = ' ';
+			char align{};		// '<', '>', '^', or 0 for the type's default.
+			char sign{};		// '+', ' ', or 0.
+			bool alternate{};	// '#': base prefix for integers.
+			bool zero{};		// '0': pad numbers with zeros after the sign.
+			size_t width{};
+			int precision = -1;
+			char type{};
+		};
+		constexpr int Max_Precision = 512;
+
+		template<typename _Elem, class _Out, class _BodyFn>
+		inline void WritePadded(_Out& out, size_t size, const Format_Spec& spec, char align, _BodyFn&& body) {
+			size_t pad = spec.width > size ? spec.width - size : 0;
+			size_t left = 0;
+			switch (spec.align ? spec.align : align) {
+			case '>':
+				left = pad;
+				break;
+			case '^':
+				left = pad / 2;
+				break;
+			}
+			const auto fill = static_cast<_Elem>(spec.fill);
+			for (size_t i = 0; i < left; ++i) {
+				out.Put(fill);
+			}
+			body(out);
+			for (size_t i = left; i < pad; ++i) {
+				out.Put(fill);
+			}
+		}
+		inline size_t PaddedSize(size_t size, const Format_Spec& spec) {
+			return std::max(size, spec.width);
+		}
+		// Locale-free number text; prefix is the sign and base prefix that
+		// zero padding goes after.
+		struct Number_Text {
+			char data[Max_Precision + std::numeric_limits<double>::max_exponent10 + 16];
+			size_t size;
+			size_t prefix;
+		};
+		inline void UpperAscii(char* first, char* last) {
+			for (; first != last; ++first) {
+				if (*first >= 'a' && *first <= 'z') {
+					*first = static_cast<char>(*first - ('a' - 'A'));
+				}
+			}
+		}
+		template<typename _Arg>
+		inline void FormatInteger(Number_Text* ptext, _Arg arg, const Format_Spec& spec) {
+			using _Unsigned = std::make_unsigned_t<_Arg>;
+			auto& text = *ptext;
+			char* pos = text.data;
+			bool negative{};
+			if constexpr (std::is_signed<_Arg>::value) {
+				negative = arg < 0;
+			}
+			_Unsigned magnitude = negative ? static_cast<_Unsigned>(_Unsigned{} - static_cast<_Unsigned>(arg)) : static_cast<_Unsigned>(arg);
+			if (negative) {
+				*pos++ = '-';
+			}
+			else if (spec.sign == '+' || spec.sign == ' ') {
+				*pos++ = spec.sign;
+			}
+			int base = 10;
+			switch (spec.type) {
+			case 'x': case 'X': base = 16; break;
+			case 'o': base = 8; break;
+			case 'b': case 'B': base = 2; break;
+			}
+			if (spec.alternate && base != 10) {
+				*pos++ = '0';
+				if (base != 8) {
+					*pos++ = spec.type;
+				}
+			}
+			text.prefix = static_cast<size_t>(pos - text.data);
+			auto digits = pos;
+			pos = std::to_chars(pos, std::end(text.data), magnitude, base).ptr;
+			if (spec.type == 'X') {
+				UpperAscii(digits, pos);
+			}
+			text.size = static_cast<size_t>(pos - text.data);
+		}
+		template<typename _Arg>
+		inline void FormatFloat(Number_Text* ptext, _Arg arg, const Format_Spec& spec) {
+			auto& text = *ptext;
+			char* pos = text.data;
+			if (!std::signbit(arg) && (spec.sign == '+' || spec.sign == ' ')) {
+				*pos++ = spec.sign;
+			}
+			text.prefix = static_cast<size_t>(pos - text.data) + (std::signbit(arg) ? 1 : 0);
+			const int precision = std::min(spec.precision, Max_Precision);
+			auto last = std::end(text.data);
+			std::to_chars_result result{};
+			switch (spec.type) {
+			case 'f': case 'F':
+				result = std::to_chars(pos, last, arg, std::chars_format::fixed, precision < 0 ? 6 : precision);
+				break;
+			case 'e': case 'E':
+				result = std::to_chars(pos, last, arg, std::chars_format::scientific, precision < 0 ? 6 : precision);
+				break;
+			case 'g': case 'G':
+				result = std::to_chars(pos, last, arg, std::chars_format::general, precision < 0 ? 6 : precision);
+				break;
+			default:
+				// shortest text that reads back to the same value.
+				result = precision < 0
+					? std::to_chars(pos, last, arg)
+					: std::to_chars(pos, last, arg, std::chars_format::general, precision);
+				break;
+			}
+			if (spec.type == 'F' || spec.type == 'E' || spec.type == 'G') {
+				UpperAscii(pos, result.ptr);
+			}
+			text.size = static_cast<size_t>(result.ptr - text.data);
+		}
+		template<typename _Elem>
+		inline size_t NumberSize(const Number_Text& text, const Format_Spec& spec) {
+			return PaddedSize(text.size, spec);
+		}
+		template<typename _Elem, class _Out>
+		inline void WriteNumber(_Out& out, const Number_Text& text, const Format_Spec& spec) {
+			if (spec.zero && !spec.align && spec.width > text.size) {
+				out.AppendNarrow(text.data, text.prefix);
+				for (size_t i = text.size; i < spec.width; ++i) {
+					out.Put(static_cast<_Elem>('0'));
+				}
+				out.AppendNarrow(text.data + text.prefix, text.size - text.prefix);
+				return;
+			}
+			WritePadded<_Elem>(out, text.size, spec, '>', [&](_Out& body) {
+				body.AppendNarrow(text.data, text.size);
+			});
+		}
+		template<typename _Elem, class _Out>
+		inline void WriteText(_Out& out, const _Elem* str, size_t size, const Format_Spec& spec) {
+			if (spec.width == 0) {
+				out.Append(str, size);
+				return;
+			}
+			WritePadded<_Elem>(out, size, spec, '<', [&](_Out& body) {
+				body.Append(str, size);
+			});
+		}
+		inline size_t TextSize(size_t size, const Format_Spec& spec) {
+			if (spec.precision >= 0) {
+				size = std::min(size, static_cast<size_t>(spec.precision));
+			}
+			return size;
+		}
+		template<typename _Elem, class _Traits>
+		struct Text_Arg_Writer {
+			static size_t Size(std::basic_string_view<_Elem, _Traits> arg, const Format_Spec& spec) {
+				return PaddedSize(TextSize(arg.size(), spec), spec);
+			}
+			template<class _Out>
+			static void Write(_Out& out, std::basic_string_view<_Elem, _Traits> arg, const Format_Spec& spec) {
+				WriteText(out, arg.data(), TextSize(arg.size(), spec), spec);
+			}
+		};
+		template<typename _Elem, class _Traits, typename _Arg, typename = void>
+		struct Arg_Writer {
+			static_assert(Always_False_v<_Arg>, "not support type.");
+		};
+		template<typename _Elem, class _Traits, class _Alloc>
+		struct Arg_Writer<_Elem, _Traits, std::basic_string<_Elem, _Traits, _Alloc>> : Text_Arg_Writer<_Elem, _Traits> {};
+		template<typename _Elem, class _Traits>
+		struct Arg_Writer<_Elem, _Traits, std::basic_string_view<_Elem, _Traits>> : Text_Arg_Writer<_Elem, _Traits> {};
+		template<typename _Elem, class _Traits>
+		struct Arg_Writer<_Elem, _Traits, const _Elem*> {
+			static size_t Size(const _Elem* arg, const Format_Spec& spec) {
+				assert(arg);
+				return Text_Arg_Writer<_Elem, _Traits>::Size(arg, spec);
+			}
+			template<class _Out>
+			static void Write(_Out& out, const _Elem* arg, const Format_Spec& spec) {
+				Text_Arg_Writer<_Elem, _Traits>::Write(out, arg, spec);
+			}
+		};
+		template<typename _Elem, class _Traits>
+		struct Arg_Writer<_Elem, _Traits, _Elem*> : Arg_Writer<_Elem, _Traits, const _Elem*> {};
+		template<typename _Elem, class _Traits>
+		struct Arg_Writer<_Elem, _Traits, _Elem> {
+			static size_t Size(_Elem, const Format_Spec& spec) {
+				return PaddedSize(1, spec);
+			}
+			template<class _Out>
+			static void Write(_Out& out, _Elem arg, const Format_Spec& spec) {
+				WriteText(out, &arg, 1, spec);
+			}
+		};
+		template<typename _Elem, class _Traits, typename _Arg>
+		struct Arg_Writer<_Elem, _Traits, _Arg, std::enable_if_t<std::is_integral<_Arg>::value && !Is_Char_Type_v<_Arg>>> {
+			using _Number = std::conditional_t<std::is_same<_Arg, bool>::value, unsigned, _Arg>;
+
+			static bool AsText(const Format_Spec& spec) {
+				return std::is_same<_Arg, bool>::value ? (!spec.type || spec.type == 's') : spec.type == 'c';
+			}
+			static size_t Size(_Arg arg, const Format_Spec& spec) {
+				if (AsText(spec)) {
+					return PaddedSize(TextLength(arg), spec);
+				}
+				Number_Text text;
+				FormatInteger(&text, static_cast<_Number>(arg), spec);
+				return NumberSize<_Elem>(text, spec);
+			}
+			template<class _Out>
+			static void Write(_Out& out, _Arg arg, const Format_Spec& spec) {
+				if (AsText(spec)) {
+					WritePadded<_Elem>(out, TextLength(arg), spec, '<', [&](_Out& body) {
+						if constexpr (std::is_same<_Arg, bool>::value) {
+							body.AppendNarrow(arg ? "true" : "false", TextLength(arg));
+						}
+						else {
+							body.Put(static_cast<_Elem>(arg));
+						}
+					});
+					return;
+				}
+				Number_Text text;
+				FormatInteger(&text, static_cast<_Number>(arg), spec);
+				WriteNumber<_Elem>(out, text, spec);
+			}
+		private:
+			static size_t TextLength(_Arg arg) {
+				if constexpr (std::is_same<_Arg, bool>::value) {
+					return arg ? 4 : 5;
+				}
+				else {
+					return 1;
+				}
+			}
+		};
+		template<typename _Elem, class _Traits, typename _Arg>
+		struct Arg_Writer<_Elem, _Traits, _Arg, std::enable_if_t<std::is_same<_Arg, float>::value || std::is_same<_Arg, double>::value>> {
+			static size_t Size(_Arg arg, const Format_Spec& spec) {
+				Number_Text text;
+				FormatFloat(&text, arg, spec);
+				return NumberSize<_Elem>(text, spec);
+			}
+			template<class _Out>
+			static void Write(_Out& out, _Arg arg, const Format_Spec& spec) {
+				Number_Text text;
+				FormatFloat(&text, arg, spec);
+				WriteNumber<_Elem>(out, text, spec);
+			}
+		};
+		template<typename _Elem, class _Traits, typename _Arg>
+		using Arg_Writer_t = Arg_Writer<_Elem, _Traits, std::decay_t<_Arg>>;
+
+		template<typename _Elem, class _Traits, typename _Arg>
+		inline size_t ArgSize(const _Arg& arg, const Format_Spec& spec = {}) {
+			return Arg_Writer_t<_Elem, _Traits, _Arg>::Size(arg, spec);
+		}
+		template<typename _Elem, class _Traits, class _Out, typename _Arg>
+		inline void WriteArg(_Out& out, const _Arg& arg, const Format_Spec& spec = {}) {
+			Arg_Writer_t<_Elem, _Traits, _Arg>::Write(out, arg, spec);
+		}
+		template<typename _Elem, class _Traits, typename ...Args>
+		inline size_t ArgSizeAt(size_t index, const Format_Spec& spec, const Args&... args) {
+			size_t i{}, size{};
+			(void)((i++ == index ? (size = ArgSize<_Elem, _Traits>(args, spec), true) : false) || ...);
+			return size;
+		}
+		template<typename _Elem, class _Traits, class _Out, typename ...Args>
+		inline void WriteArgAt(_Out& out, size_t index, const Format_Spec& spec, const Args&... args) {
+			size_t i{};
+			(void)((i++ == index ? (WriteArg<_Elem, _Traits>(out, args, spec), true) : false) || ...);
+		}
+		template<typename _Elem, class _Traits, typename ...Args>
+		inline size_t ArgsSize(const Args&... args) {
+			return (size_t{} + ... + ArgSize<_Elem, _Traits>(args));
+		}
+		template<typename _Elem, class _Traits, class _Out, typename ...Args>
+		inline void WriteArgs(_Out& out, const Args&... args) {
+			(WriteArg<_Elem, _Traits>(out, args), ...);
+		}
+		template<typename _Elem, class _Traits, class _Out, typename ...Args>
+		inline void WriteJoined(_Out& out, [[maybe_unused]] const _Elem* delim, [[maybe_unused]] size_t delimSize, const Args&... args) {
+			[[maybe_unused]] bool first = true;
+			((first ? void(first = false) : out.Append(delim, delimSize), WriteArg<_Elem, _Traits>(out, args)), ...);
+		}
+		// -------------------------------------------------------------------
+		// Format.
+		// -------------------------------------------------------------------
+		struct Format_String_Tag {};
+		struct Format_Segment {
+			size_t literalEnd;	// end of the literal text before the field.
+			size_t next;		// where parsing resumes after the field.
+			size_t index;		// argument index of the field.
+			bool field;			// false once the literal runs to the end.
+			bool ok;			// false when a malformed field stops the format.
+			Format_Spec spec;
+		};
+		template<class _Elem>
+		constexpr bool Is_Format_Align(_Elem ch) {
+			return ch == '<' || ch == '>' || ch == '^';
+		}
+		template<class _Elem>
+		constexpr bool Is_Format_Type(_Elem ch) {
+			switch (ch) {
+			case 'd': case 'x': case 'X': case 'o': case 'b': case 'B': case 'c': case 's':
+			case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+				return true;
+			}
+			return false;
+		}
+		// Parses the spec after ':' up to (not including) '}'; false when malformed.
+		template<class _Elem, class _Traits = std::char_traits<_Elem>>
+		constexpr bool ParseFormatSpec(std::basic_string_view<_Elem, _Traits> format, size_t* ppos, Format_Spec* pspec) {
+			auto& pos = *ppos;
+			auto& spec = *pspec;
+			const auto size = format.size();
+			auto digit = [&](size_t at) { return at < size && format[at] >= '0' && format[at] <= '9'; };
+			// 1. [fill]align.
+			if (pos + 1 < size && format[pos] != '}' && Is_Format_Align(format[pos + 1])) {
+				spec.fill = static_cast<uint32_t>(format[pos]);
+				spec.align = static_cast<char>(format[pos + 1]);
+				pos += 2;
+			}
+			else if (pos < size && Is_Format_Align(format[pos])) {
+				spec.align = static_cast<char>(format[pos++]);
+			}
+			// 2. sign, '#', '0'.
+			if (pos < size && (format[pos] == '+' || format[pos] == '-' || format[pos] == ' ')) {
+				spec.sign = format[pos] == '-' ? 0 : static_cast<char>(format[pos]);
+				++pos;
+			}
+			if (pos < size && format[pos] == '#') {
+				spec.alternate = true;
+				++pos;
+			}
+			if (pos < size && format[pos] == '0') {
+				spec.zero = true;
+				++pos;
+			}
+			// 3. width, precision.
+			while (digit(pos)) {
+				spec.width = spec.width * 10 + static_cast<size_t>(format[pos++] - '0');
+			}
+			if (pos < size && format[pos] == '.') {
+				++pos;
+				if (!digit(pos)) {
+					return false;
+				}
+				spec.precision = 0;
+				while (digit(pos)) {
+					spec.precision = std::min(spec.precision * 10 + static_cast<int>(format[pos++] - '0'), Max_Precision);
+				}
+			}
+			// 4. type.
+			if (pos < size && Is_Format_Type(format[pos])) {
+				spec.type = static_cast<char>(format[pos++]);
+			}
+			return pos < size && format[pos] == '}';
+		}
+		// Parses "{}", "{N}" or "{N:spec}" starting at pos; index is the implicit next argument.
+		template<class _Elem, class _Traits = std::char_traits<_Elem>>
+		constexpr Format_Segment ParseFormatSegment(std::basic_string_view<_Elem, _Traits> format, size_t pos, size_t index) {
+			Format_Segment result{ format.size(), format.size(), index, false, true, {} };
+			// 1. find '{'.
+			while (pos < format.size() && format[pos] != '{') {
+				++pos;
+			}
+			result.literalEnd = pos;
+			if (pos == format.size()) {
+				return result;
+			}
+			// 2. has index?
+			++pos;
+			if (pos < format.size() && format[pos] >= '0' && format[pos] <= '9') {
+				result.index = 0;
+				while (pos < format.size() && format[pos] >= '0' && format[pos] <= '9') {
+					result.index = result.index * 10 + static_cast<size_t>(format[pos] - '0');
+					++pos;
+				}
+			}
+			// 3. has spec?
+			if (pos < format.size() && format[pos] == ':') {
+				++pos;
+				if (!ParseFormatSpec(format, &pos, &result.spec)) {
+					result.ok = false;
+					return result;
+				}
+			}
+			// 4. is '}'?
+			if (pos == format.size() || format[pos] != '}') {
+				result.ok = false;
+				return result;
+			}
+			result.next = pos + 1;
+			result.field = true;
+			return result;
+		}
+		struct Format_Scan {
+			size_t fields;
+			size_t arity;
+			bool ok;
+		};
+		template<class _Elem, class _Traits = std::char_traits<_Elem>>
+		constexpr Format_Scan ScanFormat(std::basic_string_view<_Elem, _Traits> format) {
+			Format_Scan result{ 0, 0, true };
+			size_t pos{}, index{};
+			while (true) {
+				auto segment = ParseFormatSegment(format, pos, index);
+				if (!segment.field) {
+					result.ok = segment.ok;
+					return result;
+				}
+				++result.fields;
+				result.arity = std::max(result.arity, segment.index + 1);
+				index = segment.index + 1;
+				pos = segment.next;
+			}
+		}
+		// Literal spans and argument slots of a format string, built at compile time.
+		template<size_t _Fields>
+		struct Format_Plan {
+			size_t literalBegin[_Fields + 1]{};
+			size_t literalSize[_Fields + 1]{};
+			size_t index[_Fields + 1]{};
+			Format_Spec spec[_Fields + 1]{};
+			size_t literalTotal{};
+		};
+		template<size_t _Fields, class _Elem, class _Traits = std::char_traits<_Elem>>
+		constexpr Format_Plan<_Fields> BuildFormatPlan(std::basic_string_view<_Elem, _Traits> format) {
+			Format_Plan<_Fields> plan{};
+			size_t pos{}, index{};
+			for (size_t i = 0; i <= _Fields; ++i) {
+				auto segment = ParseFormatSegment(format, pos, index);
+				plan.literalBegin[i] = pos;
+				plan.literalSize[i] = segment.literalEnd - pos;
+				plan.index[i] = segment.index;
+				plan.spec[i] = segment.spec;
+				plan.literalTotal += plan.literalSize[i];
+				index = segment.index + 1;
+				pos = segment.next;
+			}
+			return plan;
+		}
+		// Measures/writes a format parsed at compile time; field I reads argument plan.index[I].
+		template<class _FormatString, class _Elem, class _Traits, class _Tuple, size_t ...Is>
+		inline size_t PlannedFormatSize(const _Tuple& tuple, std::index_sequence<Is...>) {
+			constexpr auto format = _FormatString::value();
+			constexpr auto plan = BuildFormatPlan<sizeof...(Is)>(format);
+			return plan.literalTotal + (size_t{} + ... + ArgSize<_Elem, _Traits>(std::get<plan.index[Is]>(tuple), plan.spec[Is]));
+		}
+		template<class _FormatString, class _Elem, class _Traits, class _Out, class _Tuple, size_t ...Is>
+		inline void WritePlannedFormat(_Out& out, const _Tuple& tuple, std::index_sequence<Is...>) {
+			constexpr auto format = _FormatString::value();
+			constexpr auto plan = BuildFormatPlan<sizeof...(Is)>(format);
+			((out.Append(format.data() + plan.literalBegin[Is], plan.literalSize[Is]),
+				WriteArg<_Elem, _Traits>(out, std::get<plan.index[Is]>(tuple), plan.spec[Is])), ...);
+			out.Append(format.data() + plan.literalBegin[sizeof...(Is)], plan.literalSize[sizeof...(Is)]);
+		}
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+		template<class _Elem, size_t _Size>
+		struct Format_Literal {
+			_Elem value[_Size]{};
+
+			constexpr Format_Literal(const _Elem(&literal)[_Size]) {
+				for (size_t i = 0; i < _Size; ++i) {
+					value[i] = literal[i];
+				}
+			}
+			constexpr auto view() const {
+				return std::basic_string_view<_Elem>(value, _Size - 1);
+			}
+		};
+		template<Format_Literal _Literal>
+		struct Format_Literal_String : Format_String_Tag {
+			static constexpr auto value() {
+				return _Literal.view();
+			}
+		};
+#endif
+	}
+	// -------------------------------------------------------------------
+	// Trim.
+	// -------------------------------------------------------------------
+	// _Policy picks the characters to strip: SpaceOnly (default), AsciiSpace,
+	// SpaceSet<...> or UnicodeSpace.
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto LTrimView(std::basic_string_view<_Elem, _Traits> rstring) {
+		detail::Api_Probe probe(StringApi::TrimView, rstring.size());
+		return rstring.substr(detail::SpacePrefix<_Policy>(rstring.data(), rstring.size()));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto RTrimView(std::basic_string_view<_Elem, _Traits> rstring) {
+		detail::Api_Probe probe(StringApi::TrimView, rstring.size());
+		return rstring.substr(0, detail::SpaceEnd<_Policy>(rstring.data(), rstring.size()));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto TrimView(std::basic_string_view<_Elem, _Traits> rstring) {
+		detail::Api_Probe probe(StringApi::TrimView, rstring.size());
+		return detail::TrimToken<_Policy>(rstring);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto LTrimView(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
+		return LTrimView<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto RTrimView(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
+		return RTrimView<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto TrimView(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
+		return TrimView<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto LTrimView(const _Elem* rstring) {
+		return LTrimView<_Policy>(std::basic_string_view<_Elem>(rstring));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto RTrimView(const _Elem* rstring) {
+		return RTrimView<_Policy>(std::basic_string_view<_Elem>(rstring));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto TrimView(const _Elem* rstring) {
+		return TrimView<_Policy>(std::basic_string_view<_Elem>(rstring));
+	}
+	// Views never own the source; refuse temporaries that would dangle.
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void LTrimView(std::basic_string<_Elem, _Traits, _Alloc>&& rstring) = delete;
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void RTrimView(std::basic_string<_Elem, _Traits, _Alloc>&& rstring) = delete;
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void TrimView(std::basic_string<_Elem, _Traits, _Alloc>&& rstring) = delete;
+
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	void LTrim(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
+		assert(pstring);
+		auto& lstring = *pstring;
+		detail::Api_Probe probe(StringApi::Trim, lstring.size());
+		lstring.erase(0, detail::SpacePrefix<_Policy>(lstring.data(), lstring.size()));
+		probe.Out(lstring.size());
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto LTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
+		detail::Api_Probe probe(StringApi::Trim, rstring.size());
+		const std::basic_string_view<_Elem, _Traits> source(rstring);
+		auto view = source.substr(detail::SpacePrefix<_Policy>(source.data(), source.size()));
+		std::basic_string<_Elem, _Traits, _Alloc> lresult(view.data(), view.size(), rstring.get_allocator());
+		probe.NewString(lresult);
+		return lresult;
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	void RTrim(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
+		assert(pstring);
+		auto& lstring = *pstring;
+		detail::Api_Probe probe(StringApi::Trim, lstring.size());
+		lstring.erase(detail::SpaceEnd<_Policy>(lstring.data(), lstring.size()));
+		probe.Out(lstring.size());
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto RTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
+		detail::Api_Probe probe(StringApi::Trim, rstring.size());
+		const std::basic_string_view<_Elem, _Traits> source(rstring);
+		auto view = source.substr(0, detail::SpaceEnd<_Policy>(source.data(), source.size()));
+		std::basic_string<_Elem, _Traits, _Alloc> lresult(view.data(), view.size(), rstring.get_allocator());
+		probe.NewString(lresult);
+		return lresult;
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	void Trim(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
+		assert(pstring);
+		auto& lstring = *pstring;
+		detail::Api_Probe probe(StringApi::Trim, lstring.size());
+		lstring.erase(detail::SpaceEnd<_Policy>(lstring.data(), lstring.size()));
+		lstring.erase(0, detail::SpacePrefix<_Policy>(lstring.data(), lstring.size()));
+		probe.Out(lstring.size());
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto Trim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
+		detail::Api_Probe probe(StringApi::Trim, rstring.size());
+		const std::basic_string_view<_Elem, _Traits> source(rstring);
+		auto view = detail::TrimToken<_Policy>(source);
+		std::basic_string<_Elem, _Traits, _Alloc> lresult(view.data(), view.size(), rstring.get_allocator());
+		probe.NewString(lresult);
+		return lresult;
+	}
+	// Element-first forms, e.g. Trim<char>(s), kept from before the policy
+	// parameter; they strip SpaceOnly and are never deduced.
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	void LTrim(std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>* pstring) {
+		LTrim<SpaceOnly>(pstring);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	auto LTrim(const std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>& rstring) {
+		return LTrim<SpaceOnly>(rstring);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	void RTrim(std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>* pstring) {
+		RTrim<SpaceOnly>(pstring);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	auto RTrim(const std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>& rstring) {
+		return RTrim<SpaceOnly>(rstring);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	void Trim(std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>* pstring) {
+		Trim<SpaceOnly>(pstring);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	auto Trim(const std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>& rstring) {
+		return Trim<SpaceOnly>(rstring);
+	}
+	// -------------------------------------------------------------------
+	// Split.
+	// -------------------------------------------------------------------
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, class _OutAlloc, class _VecAlloc>
+	void Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, std::vector< std::basic_string<_Elem, _Traits, _OutAlloc>, _VecAlloc>* presult) {
+		assert(presult);
+		auto& lresult = *presult;
+		detail::Api_Probe probe(StringApi::Split, rstring.size());
+		const size_t count = lresult.size(), capacity = lresult.capacity();
+		detail::ForEachToken<void>(std::basic_string_view<_Elem, _Traits>(rstring), detail::Char_Delim_Fn<_Elem, _Traits>(delim), [&](auto token) {
+			lresult.emplace_back(token);
+			probe.NewString(lresult.back());
+		});
+		probe.Tokens(lresult.size() - count);
+		probe.Grow(capacity, lresult.capacity(), sizeof(lresult[0]));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, class _OutAlloc, class _VecAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, std::vector< std::basic_string<_Elem, _Traits, _OutAlloc>, _VecAlloc>* presult) {
+		assert(presult);
+		auto& lresult = *presult;
+		detail::Api_Probe probe(StringApi::SplitTrim, rstring.size());
+		const size_t count = lresult.size(), capacity = lresult.capacity();
+		detail::ForEachToken<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), detail::Char_Delim_Fn<_Elem, _Traits>(delim), [&](auto token) {
+			lresult.emplace_back(token);
+			probe.NewString(lresult.back());
+		});
+		probe.Tokens(lresult.size() - count);
+		probe.Grow(capacity, lresult.capacity(), sizeof(lresult[0]));
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, class _OutAlloc, class _VecAlloc>
+	void Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, std::vector< std::basic_string<_Elem, _Traits, _OutAlloc>, _VecAlloc>* presult) {
+		assert(presult);
+		auto& lresult = *presult;
+		detail::Api_Probe probe(StringApi::Split, rstring.size());
+		const size_t count = lresult.size(), capacity = lresult.capacity();
+		detail::ForEachToken<void>(std::basic_string_view<_Elem, _Traits>(rstring), detail::Set_Delim_Fn<_Elem, _Traits>(delim), [&](auto token) {
+			lresult.emplace_back(token);
+			probe.NewString(lresult.back());
+		});
+		probe.Tokens(lresult.size() - count);
+		probe.Grow(capacity, lresult.capacity(), sizeof(lresult[0]));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, class _OutAlloc, class _VecAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, std::vector< std::basic_string<_Elem, _Traits, _OutAlloc>, _VecAlloc>* presult) {
+		assert(presult);
+		auto& lresult = *presult;
+		detail::Api_Probe probe(StringApi::SplitTrim, rstring.size());
+		const size_t count = lresult.size(), capacity = lresult.capacity();
+		detail::ForEachToken<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), detail::Set_Delim_Fn<_Elem, _Traits>(delim), [&](auto token) {
+			lresult.emplace_back(token);
+			probe.NewString(lresult.back());
+		});
+		probe.Tokens(lresult.size() - count);
+		probe.Grow(capacity, lresult.capacity(), sizeof(lresult[0]));
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+	auto Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim) {
+		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
+		Split(rstring, delim, &lresult);
+		return lresult;
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim) {
+		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
+		SplitTrim<_Policy>(rstring, delim, &lresult);
+		return lresult;
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+	auto Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim) {
+		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
+		Split(rstring, delim, &lresult);
+		return lresult;
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim) {
+		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
+		SplitTrim<_Policy>(rstring, delim, &lresult);
+		return lresult;
+	}
+	// Element-first forms, e.g. SplitTrim<char>(s, ','), as for Trim.
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, class _OutAlloc, class _VecAlloc, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	void SplitTrim(const std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>& rstring, detail::Type_Identity_t<_Elem> delim, std::vector< std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _OutAlloc>, _VecAlloc>* presult) {
+		SplitTrim<SpaceOnly>(rstring, delim, presult);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, class _OutAlloc, class _VecAlloc, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	void SplitTrim(const std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>& rstring, const detail::Type_Identity_t<_Elem>* delim, std::vector< std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _OutAlloc>, _VecAlloc>* presult) {
+		SplitTrim<SpaceOnly>(rstring, delim, presult);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	auto SplitTrim(const std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>& rstring, detail::Type_Identity_t<_Elem> delim) {
+		return SplitTrim<SpaceOnly>(rstring, delim);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, std::enable_if_t<detail::Is_Char_Type_v<_Elem>, int> = 0>
+	auto SplitTrim(const std::basic_string<detail::Type_Identity_t<_Elem>, _Traits, _Alloc>& rstring, const detail::Type_Identity_t<_Elem>* delim) {
+		return SplitTrim<SpaceOnly>(rstring, delim);
+	}
+	// -------------------------------------------------------------------
+	// TokenArena.
+	// -------------------------------------------------------------------
+	namespace detail {
+		// Random-access iterator over an indexable owner returning views by value.
+		template<class _Owner>
+		class Index_Iterator {
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = typename _Owner::value_type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type*;
+			using reference = value_type;
+
+			Index_Iterator() = default;
+			Index_Iterator(const _Owner* owner, size_t index) : owner(owner), index(index) {}
+			reference operator*() const {
+				return (*owner)[index];
+			}
+			reference operator[](difference_type offset) const {
+				return (*owner)[index + static_cast<size_t>(offset)];
+			}
+			Index_Iterator& operator++() {
+				++index;
+				return *this;
+			}
+			Index_Iterator operator++(int) {
+				auto prev = *this;
+				++index;
+				return prev;
+			}
+			Index_Iterator& operator--() {
+				--index;
+				return *this;
+			}
+			Index_Iterator operator--(int) {
+				auto prev = *this;
+				--index;
+				return prev;
+			}
+			Index_Iterator& operator+=(difference_type offset) {
+				index += static_cast<size_t>(offset);
+				return *this;
+			}
+			Index_Iterator& operator-=(difference_type offset) {
+				index -= static_cast<size_t>(offset);
+				return *this;
+			}
+			Index_Iterator operator+(difference_type offset) const {
+				return Index_Iterator(owner, index + static_cast<size_t>(offset));
+			}
+			Index_Iterator operator-(difference_type offset) const {
+				return Index_Iterator(owner, index - static_cast<size_t>(offset));
+			}
+			difference_type operator-(const Index_Iterator& other) const {
+				return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+			}
+			bool operator==(const Index_Iterator& other) const {
+				return index == other.index;
+			}
+			bool operator!=(const Index_Iterator& other) const {
+				return index != other.index;
+			}
+			bool operator<(const Index_Iterator& other) const {
+				return index < other.index;
+			}
+			bool operator>(const Index_Iterator& other) const {
+				return index > other.index;
+			}
+			bool operator<=(const Index_Iterator& other) const {
+				return index <= other.index;
+			}
+			bool operator>=(const Index_Iterator& other) const {
+				return index >= other.index;
+			}
+			friend Index_Iterator operator+(difference_type offset, const Index_Iterator& it) {
+				return it + offset;
+			}
+		private:
+			const _Owner* owner{};
+			size_t index{};
+		};
+	}
+	// Split output packed into one character buffer plus an end-offset per
+	// token; clear() drops a whole batch and keeps both capacities.
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+	class TokenArena {
+		using _Offset_Alloc = typename std::allocator_traits<_Alloc>::template rebind_alloc<size_t>;
+	public:
+		using value_type = std::basic_string_view<_Elem, _Traits>;
+		using allocator_type = _Alloc;
+
+		using iterator = detail::Index_Iterator<TokenArena>;
+
+		TokenArena() = default;
+		explicit TokenArena(const _Alloc& alloc) : chars(alloc), offsets(_Offset_Alloc(alloc)) {}
+
+		size_t size() const {
+			return offsets.size();
+		}
+		bool empty() const {
+			return offsets.empty();
+		}
+		value_type operator[](size_t index) const {
+			assert(index < offsets.size());
+			size_t first = index ? offsets[index - 1] : 0;
+			return value_type(chars.data() + first, offsets[index] - first);
+		}
+		iterator begin() const {
+			return iterator(this, 0);
+		}
+		iterator end() const {
+			return iterator(this, offsets.size());
+		}
+		// All token characters, back to back.
+		value_type chars_view() const {
+			return value_type(chars.data(), chars.size());
+		}
+		// Character capacity.
+		size_t capacity() const {
+			return chars.capacity();
+		}
+		void clear() {
+			chars.clear();
+			offsets.clear();
+		}
+		void reserve(size_t charCount, size_t tokenCount) {
+			chars.reserve(charCount);
+			offsets.reserve(tokenCount);
+		}
+		// Grows the character buffer geometrically so a batch of lines costs
+		// O(log n) reallocations instead of one per line.
+		void reserve_more(size_t charCount) {
+			if (chars.size() + charCount > chars.capacity()) {
+				chars.reserve(std::max(chars.capacity() * 2, chars.size() + charCount));
+			}
+		}
+		void push_back(value_type token) {
+			chars.insert(chars.end(), token.begin(), token.end());
+			offsets.push_back(chars.size());
+		}
+	private:
+		std::vector<_Elem, _Alloc> chars;
+		std::vector<size_t, _Offset_Alloc> offsets;
+	};
+	namespace pmr {
+		template <class _Elem, class _Traits = std::char_traits<_Elem>>
+		using TokenArena = cpp::TokenArena<_Elem, _Traits, std::pmr::polymorphic_allocator<_Elem>>;
+	}
+	template <class _Elem, class _Traits, class _ArenaAlloc>
+	void Split(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, TokenArena<_Elem, _Traits, _ArenaAlloc>* parena) {
+		assert(parena);
+		auto& larena = *parena;
+		detail::Api_Probe probe(StringApi::Split, rstring.size());
+		const size_t count = larena.size(), chars = larena.chars_view().size(), capacity = larena.capacity();
+		larena.reserve_more(rstring.size());
+		detail::ForEachToken<void>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim), [&](auto token) {
+			larena.push_back(token);
+		});
+		probe.Tokens(larena.size() - count);
+		probe.Out(larena.chars_view().size() - chars);
+		probe.Grow(capacity, larena.capacity(), sizeof(_Elem));
+	}
+	template <class _Elem, class _Traits, class _Alloc, class _ArenaAlloc>
+	void Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, TokenArena<_Elem, _Traits, _ArenaAlloc>* parena) {
+		Split(std::basic_string_view<_Elem, _Traits>(rstring), delim, parena);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _ArenaAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, TokenArena<_Elem, _Traits, _ArenaAlloc>* parena) {
+		assert(parena);
+		auto& larena = *parena;
+		detail::Api_Probe probe(StringApi::SplitTrim, rstring.size());
+		const size_t count = larena.size(), chars = larena.chars_view().size(), capacity = larena.capacity();
+		larena.reserve_more(rstring.size());
+		detail::ForEachToken<_Policy>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim), [&](auto token) {
+			larena.push_back(token);
+		});
+		probe.Tokens(larena.size() - count);
+		probe.Out(larena.chars_view().size() - chars);
+		probe.Grow(capacity, larena.capacity(), sizeof(_Elem));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _ArenaAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, TokenArena<_Elem, _Traits, _ArenaAlloc>* parena) {
+		SplitTrim<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim, parena);
+	}
+	template <class _Elem, class _Traits, class _ArenaAlloc>
+	void Split(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, TokenArena<_Elem, _Traits, _ArenaAlloc>* parena) {
+		assert(parena);
+		auto& larena = *parena;
+		detail::Api_Probe probe(StringApi::Split, rstring.size());
+		const size_t count = larena.size(), chars = larena.chars_view().size(), capacity = larena.capacity();
+		larena.reserve_more(rstring.size());
+		detail::ForEachToken<void>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim), [&](auto token) {
+			larena.push_back(token);
+		});
+		probe.Tokens(larena.size() - count);
+		probe.Out(larena.chars_view().size() - chars);
+		probe.Grow(capacity, larena.capacity(), sizeof(_Elem));
+	}
+	template <class _Elem, class _Traits, class _Alloc, class _ArenaAlloc>
+	void Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, TokenArena<_Elem, _Traits, _ArenaAlloc>* parena) {
+		Split(std::basic_string_view<_Elem, _Traits>(rstring), delim, parena);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _ArenaAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, TokenArena<_Elem, _Traits, _ArenaAlloc>* parena) {
+		assert(parena);
+		auto& larena = *parena;
+		detail::Api_Probe probe(StringApi::SplitTrim, rstring.size());
+		const size_t count = larena.size(), chars = larena.chars_view().size(), capacity = larena.capacity();
+		larena.reserve_more(rstring.size());
+		detail::ForEachToken<_Policy>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim), [&](auto token) {
+			larena.push_back(token);
+		});
+		probe.Tokens(larena.size() - count);
+		probe.Out(larena.chars_view().size() - chars);
+		probe.Grow(capacity, larena.capacity(), sizeof(_Elem));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _ArenaAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, TokenArena<_Elem, _Traits, _ArenaAlloc>* parena) {
+		SplitTrim<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim, parena);
+	}
+	namespace pmr {
+		// Split into strings and a vector that all draw from one memory resource,
+		// e.g. a std::pmr::monotonic_buffer_resource released per batch.
+		template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+		auto Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, std::pmr::memory_resource* resource) {
+			std::pmr::vector<std::pmr::basic_string<_Elem, _Traits>> lresult(resource);
+			cpp::Split(rstring, delim, &lresult);
+			return lresult;
+		}
+		template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+		auto Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, std::pmr::memory_resource* resource) {
+			std::pmr::vector<std::pmr::basic_string<_Elem, _Traits>> lresult(resource);
+			cpp::Split(rstring, delim, &lresult);
+			return lresult;
+		}
+		template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+		auto SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, std::pmr::memory_resource* resource) {
+			std::pmr::vector<std::pmr::basic_string<_Elem, _Traits>> lresult(resource);
+			cpp::SplitTrim<_Policy>(rstring, delim, &lresult);
+			return lresult;
+		}
+		template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+		auto SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, std::pmr::memory_resource* resource) {
+			std::pmr::vector<std::pmr::basic_string<_Elem, _Traits>> lresult(resource);
+			cpp::SplitTrim<_Policy>(rstring, delim, &lresult);
+			return lresult;
+		}
+	}
+	// -------------------------------------------------------------------
+	// StringPool.
+	// -------------------------------------------------------------------
+	namespace detail {
+		inline uint64_t LoadU64(const unsigned char* bytes) {
+			uint64_t value;
+			std::memcpy(&value, bytes, sizeof(value));
+			return value;
+		}
+		inline uint64_t HashMix(uint64_t value) {
+			value ^= value >> 32;
+			value *= 0xD6E8FEB86659FD93ull;
+			value ^= value >> 32;
+			return value;
+		}
+		// Non-cryptographic, 8 bytes per step; the tail is read as one
+		// overlapping word so short tokens take no byte loop.
+		inline uint64_t HashBytes(const void* data, size_t size) {
+			constexpr uint64_t _Prime = 0x9E3779B97F4A7C15ull;
+			auto bytes = static_cast<const unsigned char*>(data);
+			uint64_t hash = size * _Prime;
+			if (size >= 8) {
+				auto last = bytes + size - 8;
+				for (; bytes < last; bytes += 8) {
+					hash = (hash ^ LoadU64(bytes)) * _Prime;
+					hash ^= hash >> 29;
+				}
+				hash = (hash ^ LoadU64(last)) * _Prime;
+			}
+			else if (size >= 4) {
+				uint32_t low, high;
+				std::memcpy(&low, bytes, 4);
+				std::memcpy(&high, bytes + size - 4, 4);
+				hash = (hash ^ (uint64_t(high) << 32 | low)) * _Prime;
+			}
+			else if (size) {
+				uint64_t value = uint64_t(bytes[0]) << 16 | uint64_t(bytes[size >> 1]) << 8 | bytes[size - 1];
+				hash = (hash ^ value) * _Prime;
+			}
+			return HashMix(hash);
+		}
+		template<class _Elem, class _Traits>
+		inline uint64_t HashToken(std::basic_string_view<_Elem, _Traits> token) {
+			return HashBytes(token.data(), token.size() * sizeof(_Elem));
+		}
+	}
+	// Interns tokens: every distinct token is stored once and gets a dense
+	// 32-bit id, so repeated columns cost an id each and compare as integers.
+	// Characters live in fixed chunks, so views handed out stay valid until
+	// clear(). Not thread-safe, see ShardedStringPool.
+	template <class _Elem, class _Traits = std::char_traits<_Elem>>
+	class StringPool {
+	public:
+		using value_type = std::basic_string_view<_Elem, _Traits>;
+		using id_type = uint32_t;
+		static constexpr id_type npos = ~id_type(0);
+
+		StringPool() = default;
+		explicit StringPool(size_t chunkSize) : chunkSize(std::max<size_t>(chunkSize, 1)) {}
+		// The source is left empty and usable, its next token opens a chunk.
+		StringPool(StringPool&& other) noexcept
+			: chunkSize(other.chunkSize), used(other.used), large(other.large), chunks(std::move(other.chunks)),
+			blocks(std::move(other.blocks)), views(std::move(other.views)), slots(std::move(other.slots)) {
+			other.clear();
+		}
+		StringPool& operator=(StringPool&& other) noexcept {
+			if (this != &other) {
+				chunkSize = other.chunkSize;
+				used = other.used;
+				large = other.large;
+				chunks = std::move(other.chunks);
+				blocks = std::move(other.blocks);
+				views = std::move(other.views);
+				slots = std::move(other.slots);
+				other.clear();
+			}
+			return *this;
+		}
+
+		size_t size() const {
+			return views.size();
+		}
+		bool empty() const {
+			return views.empty();
+		}
+		value_type operator[](id_type id) const {
+			assert(id < views.size());
+			return views[id];
+		}
+		// Bytes held by the pool, chunks and table included.
+		size_t memory_usage() const {
+			return chunks.size() * chunkSize * sizeof(_Elem) + large + views.capacity() * sizeof(value_type) + slots.capacity() * sizeof(Slot);
+		}
+		void reserve(size_t count) {
+			views.reserve(count);
+			if (count * 2 > slots.size()) {
+				Rehash(count * 2);
+			}
+		}
+		void clear() {
+			chunks.clear();
+			blocks.clear();
+			views.clear();
+			slots.clear();
+			used = chunkSize;
+			large = 0;
+		}
+		id_type Find(value_type token) const {
+			return Find(token, detail::HashToken(token));
+		}
+		id_type Find(value_type token, uint64_t hash) const {
+			if (slots.empty()) {
+				return npos;
+			}
+			const auto tag = static_cast<uint32_t>(hash);
+			for (size_t index = tag & (slots.size() - 1);; index = (index + 1) & (slots.size() - 1)) {
+				const auto& slot = slots[index];
+				if (slot.id == npos) {
+					return npos;
+				}
+				if (slot.hash == tag && views[slot.id] == token) {
+					return slot.id;
+				}
+			}
+		}
+		id_type Intern(value_type token) {
+			return Intern(token, detail::HashToken(token));
+		}
+		// hash must be detail::HashToken(token); lets callers hash outside a lock.
+		id_type Intern(value_type token, uint64_t hash) {
+			if ((views.size() + 1) * 2 > slots.size()) {
+				Rehash(std::max<size_t>(slots.size() * 2, 16));
+			}
+			const auto tag = static_cast<uint32_t>(hash);
+			size_t index = tag & (slots.size() - 1);
+			for (;; index = (index + 1) & (slots.size() - 1)) {
+				const auto& slot = slots[index];
+				if (slot.id == npos) {
+					break;
+				}
+				if (slot.hash == tag && views[slot.id] == token) {
+					return slot.id;
+				}
+			}
+			if (views.size() >= npos) {
+				throw std::length_error("StringPool: too many strings");
+			}
+			auto id = static_cast<id_type>(views.size());
+			views.push_back(Store(token));
+			slots[index] = Slot{ tag, id };
+			return id;
+		}
+		// The pooled copy of token, valid until clear().
+		value_type InternView(value_type token) {
+			return views[Intern(token)];
+		}
+	private:
+		// 8 bytes: probing compares the hash tag and only then the token.
+		struct Slot {
+			uint32_t hash;
+			id_type id;
+		};
+		value_type Store(value_type token) {
+			if (token.empty()) {
+				return value_type();
+			}
+			_Elem* data;
+			if (token.size() > chunkSize / 4) {
+				// Big tokens get their own block and leave the open chunk alone.
+				blocks.emplace_back(new _Elem[token.size()]);
+				data = blocks.back().get();
+				large += token.size() * sizeof(_Elem);
+			}
+			else {
+				if (chunkSize - used < token.size()) {
+					chunks.emplace_back(new _Elem[chunkSize]);
+					used = 0;
+				}
+				data = chunks.back().get() + used;
+				used += token.size();
+			}
+			_Traits::copy(data, token.data(), token.size());
+			return value_type(data, token.size());
+		}
+		void Rehash(size_t count) {
+			size_t capacity = 16;
+			while (capacity < count) {
+				capacity *= 2;
+			}
+			std::vector<Slot> lslots(capacity, Slot{ 0, npos });
+			for (const auto& slot : slots) {
+				if (slot.id != npos) {
+					size_t index = slot.hash & (capacity - 1);
+					while (lslots[index].id != npos) {
+						index = (index + 1) & (capacity - 1);
+					}
+					lslots[index] = slot;
+				}
+			}
+			slots.swap(lslots);
+		}
+
+		size_t chunkSize{ 64 * 1024 / sizeof(_Elem) };
+		size_t used{ chunkSize };
+		size_t large{};
+		std::vector<std::unique_ptr<_Elem[]>> chunks;
+		std::vector<std::unique_ptr<_Elem[]>> blocks;
+		std::vector<value_type> views;
+		std::vector<Slot> slots;
+	};
+	// StringPool split by hash into 2^_ShardBits independently locked
+	// shards for concurrent ingest. Ids carry the shard in their low bits and
+	// are unique across the pool but not dense.
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, size_t _ShardBits = 4>
+	class ShardedStringPool {
+		static_assert(_ShardBits > 0 && _ShardBits < 16, "invalid shard bits.");
+	public:
+		using value_type = std::basic_string_view<_Elem, _Traits>;
+		using id_type = uint32_t;
+		static constexpr id_type npos = ~id_type(0);
+		static constexpr size_t shard_count = size_t(1) << _ShardBits;
+
+		ShardedStringPool() = default;
+		ShardedStringPool(const ShardedStringPool&) = delete;
+		ShardedStringPool& operator=(const ShardedStringPool&) = delete;
+
+		size_t size() const {
+			size_t count{};
+			for (auto& shard : shards) {
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				count += shard.pool.size();
+			}
+			return count;
+		}
+		size_t memory_usage() const {
+			size_t bytes{};
+			for (auto& shard : shards) {
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				bytes += shard.pool.memory_usage();
+			}
+			return bytes;
+		}
+		void clear() {
+			for (auto& shard : shards) {
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				shard.pool.clear();
+			}
+		}
+		// The token for id; the view stays valid until clear().
+		value_type operator[](id_type id) const {
+			auto& shard = shards[id & (shard_count - 1)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			return shard.pool[id >> _ShardBits];
+		}
+		id_type Find(value_type token) const {
+			auto hash = detail::HashToken(token);
+			auto index = ShardOf(hash);
+			auto& shard = shards[index];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			auto id = shard.pool.Find(token, hash);
+			return id == npos ? npos : MakeId(id, index);
+		}
+		id_type Intern(value_type token) {
+			auto hash = detail::HashToken(token);
+			auto index = ShardOf(hash);
+			auto& shard = shards[index];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			return MakeId(shard.pool.Intern(token, hash), index);
+		}
+		value_type InternView(value_type token) {
+			auto hash = detail::HashToken(token);
+			auto& shard = shards[ShardOf(hash)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			return shard.pool[shard.pool.Intern(token, hash)];
+		}
+	private:
+		// The table indexes by the low hash bits, shards by the high ones.
+		static size_t ShardOf(uint64_t hash) {
+			return static_cast<size_t>(hash >> (64 - _ShardBits));
+		}
+		static id_type MakeId(id_type id, size_t index) {
+			if (id >= (npos >> _ShardBits)) {
+				throw std::length_error("ShardedStringPool: too many strings");
+			}
+			return id << _ShardBits | static_cast<id_type>(index);
+		}
+		struct alignas(64) Shard {
+			mutable std::mutex mutex;
+			StringPool<_Elem, _Traits> pool;
+		};
+		Shard shards[shard_count];
+	};
+	namespace detail {
+		template<class _Pool, class _Elem, class _Traits>
+		struct Is_String_Pool : std::false_type {};
+		template<class _Elem, class _Traits>
+		struct Is_String_Pool<StringPool<_Elem, _Traits>, _Elem, _Traits> : std::true_type {};
+		template<class _Elem, class _Traits, size_t _ShardBits>
+		struct Is_String_Pool<ShardedStringPool<_Elem, _Traits, _ShardBits>, _Elem, _Traits> : std::true_type {};
+		template<class _Pool, class _Elem, class _Traits>
+		using Enable_If_Pool_t = std::enable_if_t<Is_String_Pool<_Pool, _Elem, _Traits>::value, int>;
+
+		template<class _Trim, class _Elem, class _Traits, class _DelimFn, class _Pool, class _Type, class _Alloc>
+		inline void InternTokens(std::basic_string_view<_Elem, _Traits> rstring, const _DelimFn& fn, _Pool* ppool, std::vector<_Type, _Alloc>* presult) {
+			assert(ppool && presult);
+			auto& lpool = *ppool;
+			auto& lresult = *presult;
+			Api_Probe probe(StringApi::Intern, rstring.size());
+			const size_t count = lresult.size(), capacity = lresult.capacity();
+			ForEachToken<_Trim>(rstring, fn, [&](auto token) {
+				if constexpr (std::is_same<_Type, std::basic_string_view<_Elem, _Traits>>::value) {
+					lresult.push_back(lpool.InternView(token));
+				}
+				else {
+					static_assert(std::is_same<_Type, uint32_t>::value, "not support type.");
+					lresult.push_back(lpool.Intern(token));
+				}
+			});
+			probe.Tokens(lresult.size() - count);
+			probe.Grow(capacity, lresult.capacity(), sizeof(_Type));
+		}
+	}
+	// Interned split: appends an id (std::vector<uint32_t>) or the pooled
+	// view (std::vector<basic_string_view>) per token.
+	template <class _Elem, class _Traits, class _Pool, class _Type, class _Alloc, detail::Enable_If_Pool_t<_Pool, _Elem, _Traits> = 0>
+	void Split(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, _Pool* ppool, std::vector<_Type, _Alloc>* presult) {
+		detail::InternTokens<void>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim), ppool, presult);
+	}
+	template <class _Elem, class _Traits, class _Alloc, class _Pool, class _Type, class _ResultAlloc, detail::Enable_If_Pool_t<_Pool, _Elem, _Traits> = 0>
+	void Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, _Pool* ppool, std::vector<_Type, _ResultAlloc>* presult) {
+		Split(std::basic_string_view<_Elem, _Traits>(rstring), delim, ppool, presult);
+	}
+	template <class _Elem, class _Traits, class _Pool, class _Type, class _Alloc, detail::Enable_If_Pool_t<_Pool, _Elem, _Traits> = 0>
+	void Split(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, _Pool* ppool, std::vector<_Type, _Alloc>* presult) {
+		detail::InternTokens<void>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim), ppool, presult);
+	}
+	template <class _Elem, class _Traits, class _Alloc, class _Pool, class _Type, class _ResultAlloc, detail::Enable_If_Pool_t<_Pool, _Elem, _Traits> = 0>
+	void Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, _Pool* ppool, std::vector<_Type, _ResultAlloc>* presult) {
+		Split(std::basic_string_view<_Elem, _Traits>(rstring), delim, ppool, presult);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Pool, class _Type, class _Alloc, detail::Enable_If_Pool_t<_Pool, _Elem, _Traits> = 0, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, _Pool* ppool, std::vector<_Type, _Alloc>* presult) {
+		detail::InternTokens<_Policy>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim), ppool, presult);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _Pool, class _Type, class _ResultAlloc, detail::Enable_If_Pool_t<_Pool, _Elem, _Traits> = 0, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, _Pool* ppool, std::vector<_Type, _ResultAlloc>* presult) {
+		SplitTrim<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim, ppool, presult);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Pool, class _Type, class _Alloc, detail::Enable_If_Pool_t<_Pool, _Elem, _Traits> = 0, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, _Pool* ppool, std::vector<_Type, _Alloc>* presult) {
+		detail::InternTokens<_Policy>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim), ppool, presult);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _Pool, class _Type, class _ResultAlloc, detail::Enable_If_Pool_t<_Pool, _Elem, _Traits> = 0, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, _Pool* ppool, std::vector<_Type, _ResultAlloc>* presult) {
+		SplitTrim<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim, ppool, presult);
+	}
+	// -------------------------------------------------------------------
+	// SplitView.
+	// -------------------------------------------------------------------
+	template <class _Elem, class _Traits, class _DelimFn, class _Trim>
+	class BasicSplitView {
+	public:
+		using value_type = std::basic_string_view<_Elem, _Traits>;
+
+		class iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::basic_string_view<_Elem, _Traits>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type*;
+			using reference = value_type;
+
+			iterator() = default;
+			reference operator*() const {
+				value_type token(first, static_cast<size_t>(delim - first));
+				if constexpr (!std::is_void<_Trim>::value) {
+					return detail::TrimToken<_Trim>(token);
+				}
+				else {
+					return token;
+				}
+			}
+			iterator& operator++() {
+				if (delim == last) {
+					done = true;
+					return *this;
+				}
+				first = delim + 1;
+				delim = (*fn)(first, last);
+				return *this;
+			}
+			iterator operator++(int) {
+				auto prev = *this;
+				++*this;
+				return prev;
+			}
+			bool operator==(const iterator& other) const {
+				return done == other.done && (done || first == other.first);
+			}
+			bool operator!=(const iterator& other) const {
+				return !(*this == other);
+			}
+		private:
+			friend class BasicSplitView;
+			iterator(const _DelimFn* fn, const _Elem* first, const _Elem* last)
+				: fn(fn), first(first), delim((*fn)(first, last)), last(last), done(false) {}
+
+			const _DelimFn* fn{};
+			const _Elem* first{};
+			const _Elem* delim{};
+			const _Elem* last{};
+			bool done{ true };
+		};
+
+		BasicSplitView(std::basic_string_view<_Elem, _Traits> rstring, _DelimFn fn)
+			: source(rstring), fn(fn) {}
+
+		iterator begin() const {
+			return iterator(&fn, source.data(), source.data() + source.size());
+		}
+		iterator end() const {
+			return iterator{};
+		}
+	private:
+		std::basic_string_view<_Elem, _Traits> source;
+		_DelimFn fn;
+	};
+	template <class _Elem, class _Traits>
+	using BasicCharSplitView = BasicSplitView<_Elem, _Traits, detail::Char_Delim_Fn<_Elem, _Traits>, void>;
+	template <class _Elem, class _Traits>
+	using BasicSetSplitView = BasicSplitView<_Elem, _Traits, detail::Set_Delim_Fn<_Elem, _Traits>, void>;
+	template <class _Elem, class _Traits, class _Policy = SpaceOnly>
+	using BasicCharSplitTrimView = BasicSplitView<_Elem, _Traits, detail::Char_Delim_Fn<_Elem, _Traits>, _Policy>;
+	template <class _Elem, class _Traits, class _Policy = SpaceOnly>
+	using BasicSetSplitTrimView = BasicSplitView<_Elem, _Traits, detail::Set_Delim_Fn<_Elem, _Traits>, _Policy>;
+
+	template <class _Elem, class _Traits>
+	auto SplitView(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim) {
+		return BasicCharSplitView<_Elem, _Traits>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim));
+	}
+	template <class _Elem, class _Traits>
+	auto SplitView(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim) {
+		return BasicSetSplitView<_Elem, _Traits>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto SplitTrimView(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim) {
+		return BasicCharSplitTrimView<_Elem, _Traits, _Policy>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto SplitTrimView(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim) {
+		return BasicSetSplitTrimView<_Elem, _Traits, _Policy>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim));
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, class _Delim>
+	auto SplitView(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Delim delim) {
+		return SplitView(std::basic_string_view<_Elem, _Traits>(rstring), delim);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, class _Delim, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto SplitTrimView(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Delim delim) {
+		return SplitTrimView<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim);
+	}
+	template <class _Elem, class _Delim>
+	auto SplitView(const _Elem* rstring, _Delim delim) {
+		return SplitView(std::basic_string_view<_Elem>(rstring), delim);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Delim, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto SplitTrimView(const _Elem* rstring, _Delim delim) {
+		return SplitTrimView<_Policy>(std::basic_string_view<_Elem>(rstring), delim);
+	}
+	// Views never own the source; refuse temporaries that would dangle.
+	template <class _Elem, class _Traits, class _Alloc, class _Delim>
+	void SplitView(std::basic_string<_Elem, _Traits, _Alloc>&& rstring, _Delim delim) = delete;
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _Delim, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrimView(std::basic_string<_Elem, _Traits, _Alloc>&& rstring, _Delim delim) = delete;
+	// -------------------------------------------------------------------
+	// SplitAs / ParseFields.
+	// -------------------------------------------------------------------
+	// A field that failed keeps its slot (value-initialized), so values
+	// stay aligned with fields; error codes follow std::from_chars.
+	struct FieldError {
+		size_t field;
+		std::errc error;
+	};
+	struct FieldsResult {
+		size_t count{};			// fields seen.
+		size_t failed{};		// fields that did not parse.
+		size_t firstFailed{};	// index of the first of them, valid when failed != 0.
+		std::errc error{};		// and its error.
+
+		explicit operator bool() const {
+			return failed == 0;
+		}
+	};
+	template <size_t _Count>
+	struct FieldStatus {
+		std::array<std::errc, _Count> errors{};	// std::errc{} for a parsed field.
+		size_t count{};							// fields in the line.
+
+		bool ok() const {
+			return count == _Count && std::all_of(errors.begin(), errors.end(), [](std::errc error) { return error == std::errc{}; });
+		}
+		explicit operator bool() const {
+			return ok();
+		}
+	};
+	template <class... _Types>
+	struct ParsedFields : FieldStatus<sizeof...(_Types)> {
+		std::tuple<_Types...> values{};
+	};
+	namespace detail {
+		template<class _Type, class _Elem, class _Traits>
+		struct Is_String_Of : std::false_type {};
+		template<class _Elem, class _Traits, class _Alloc>
+		struct Is_String_Of<std::basic_string<_Elem, _Traits, _Alloc>, _Elem, _Traits> : std::true_type {};
+		// Parsed into views, which must not outlive the line.
+		template<class _Type>
+		struct Is_String_View : std::false_type {};
+		template<class _Elem, class _Traits>
+		struct Is_String_View<std::basic_string_view<_Elem, _Traits>> : std::true_type {};
+		template<class... _Types>
+		using Enable_If_Views_t = std::enable_if_t<(Is_String_View<_Types>::value || ...), int>;
+		// Longest wide token narrowed for from_chars.
+		constexpr size_t Max_Number_Chars = 128;
+
+		template<class _Type>
+		inline std::errc ParseNumber(const char* first, const char* last, _Type* pvalue) {
+			// from_chars takes no '+'.
+			if (last - first > 1 && *first == '+' && first[1] != '-') {
+				++first;
+			}
+			_Type value{};
+			auto result = std::from_chars(first, last, value);
+			if (result.ec != std::errc{}) {
+				return result.ec;
+			}
+			if (result.ptr != last) {
+				return std::errc::invalid_argument;
+			}
+			*pvalue = value;
+			return std::errc{};
+		}
+		// Parses a whole token into *pvalue, which is left alone on error.
+		template<class _Type, class _Elem, class _Traits>
+		inline std::errc ParseValue(std::basic_string_view<_Elem, _Traits> token, _Type* pvalue) {
+			if constexpr (std::is_same<_Type, std::basic_string_view<_Elem, _Traits>>::value) {
+				*pvalue = token;
+				return std::errc{};
+			}
+			else if constexpr (Is_String_Of<_Type, _Elem, _Traits>::value) {
+				pvalue->assign(token.data(), token.size());
+				return std::errc{};
+			}
+			else if constexpr (std::is_arithmetic<_Type>::value && !std::is_same<_Type, bool>::value) {
+				if constexpr (std::is_same<_Elem, char>::value) {
+					return ParseNumber(token.data(), token.data() + token.size(), pvalue);
+				}
+				else {
+					char buffer[Max_Number_Chars];
+					if (token.size() > Max_Number_Chars) {
+						return std::errc::invalid_argument;
+					}
+					for (size_t i = 0; i < token.size(); ++i) {
+						if (static_cast<std::make_unsigned_t<_Elem>>(token[i]) > 0x7F) {
+							return std::errc::invalid_argument;
+						}
+						buffer[i] = static_cast<char>(token[i]);
+					}
+					return ParseNumber(buffer, buffer + token.size(), pvalue);
+				}
+			}
+			else {
+				static_assert(Always_False_v<_Type>, "not support type.");
+				return std::errc::invalid_argument;
+			}
+		}
+		inline void RecordError(FieldsResult* presult, std::vector<FieldError>* perrors, size_t field, std::errc error) {
+			if (presult->failed++ == 0) {
+				presult->firstFailed = field;
+				presult->error = error;
+			}
+			if (perrors) {
+				perrors->push_back(FieldError{ field, error });
+			}
+		}
+		template<class _Policy, class _Type, class _Elem, class _Traits, class _DelimFn, class _Alloc>
+		inline FieldsResult SplitAsTo(std::basic_string_view<_Elem, _Traits> rstring, const _DelimFn& fn, std::vector<_Type, _Alloc>* presult, std::vector<FieldError>* perrors) {
+			assert(presult);
+			auto& lresult = *presult;
+			Api_Probe probe(StringApi::SplitAs, rstring.size());
+			const size_t capacity = lresult.capacity();
+			FieldsResult result{};
+			ForEachToken<_Policy>(rstring, fn, [&](auto token) {
+				lresult.emplace_back();
+				auto error = ParseValue(token, &lresult.back());
+				if (error != std::errc{}) {
+					RecordError(&result, perrors, result.count, error);
+				}
+				++result.count;
+			});
+			probe.Tokens(result.count);
+			probe.Grow(capacity, lresult.capacity(), sizeof(_Type));
+			return result;
+		}
+		// Fields past capacity are counted and reported as value_too_large.
+		template<class _Policy, class _Type, class _Elem, class _Traits, class _DelimFn>
+		inline FieldsResult SplitAsTo(std::basic_string_view<_Elem, _Traits> rstring, const _DelimFn& fn, _Type* pvalues, size_t capacity, std::vector<FieldError>* perrors) {
+			assert(pvalues || capacity == 0);
+			Api_Probe probe(StringApi::SplitAs, rstring.size());
+			FieldsResult result{};
+			ForEachToken<_Policy>(rstring, fn, [&](auto token) {
+				auto error = std::errc::value_too_large;
+				if (result.count < capacity) {
+					pvalues[result.count] = _Type{};
+					error = ParseValue(token, &pvalues[result.count]);
+				}
+				if (error != std::errc{}) {
+					RecordError(&result, perrors, result.count, error);
+				}
+				++result.count;
+			});
+			probe.Tokens(result.count);
+			return result;
+		}
+		// Fields are taken in order; missing ones are invalid_argument, extra
+		// ones are only counted.
+		template<class _Policy, class _Elem, class _Traits, class _DelimFn, size_t... _Index, class... _Types>
+		inline auto ParseFieldsTo(std::basic_string_view<_Elem, _Traits> line, const _DelimFn& fn, std::index_sequence<_Index...>, _Types*... pvalues) {
+			Api_Probe probe(StringApi::ParseFields, line.size());
+			FieldStatus<sizeof...(_Types)> status{};
+			auto first = line.data();
+			const auto last = first + line.size();
+			bool more = true;
+			auto next = [&](auto* pvalue, std::errc* perror) {
+				if (!more) {
+					*perror = std::errc::invalid_argument;
+					return;
+				}
+				auto delim = fn(first, last);
+				std::basic_string_view<_Elem, _Traits> token(first, static_cast<size_t>(delim - first));
+				if constexpr (!std::is_void<_Policy>::value) {
+					token = TrimToken<_Policy>(token);
+				}
+				*perror = ParseValue(token, pvalue);
+				++status.count;
+				more = delim != last;
+				first = more ? delim + 1 : last;
+			};
+			(next(pvalues, &status.errors[_Index]), ...);
+			while (more) {
+				auto delim = fn(first, last);
+				++status.count;
+				more = delim != last;
+				first = more ? delim + 1 : last;
+			}
+			probe.Tokens(status.count);
+			return status;
+		}
+		template<class _Policy, class... _Types, class _Elem, class _Traits, class _DelimFn, size_t... _Index>
+		inline auto ParseFieldsAs(std::basic_string_view<_Elem, _Traits> line, const _DelimFn& fn, std::index_sequence<_Index...> sequence) {
+			ParsedFields<_Types...> fields{};
+			static_cast<FieldStatus<sizeof...(_Types)>&>(fields) = ParseFieldsTo<_Policy>(line, fn, sequence, &std::get<_Index>(fields.values)...);
+			return fields;
+		}
+		template<class _Elem, class _Traits, class _Delim>
+		inline auto MakeDelimFn(_Delim delim) {
+			using _DelimFn = std::conditional_t<std::is_pointer<_Delim>::value, Set_Delim_Fn<_Elem, _Traits>, Char_Delim_Fn<_Elem, _Traits>>;
+			return _DelimFn(delim);
+		}
+	}
+	template <class _Type, class _Policy = void, class _Elem, class _Traits, class _Alloc>
+	FieldsResult SplitAs(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, std::vector<_Type, _Alloc>* presult, std::vector<FieldError>* perrors = nullptr) {
+		return detail::SplitAsTo<_Policy>(rstring, detail::MakeDelimFn<_Elem, _Traits>(delim), presult, perrors);
+	}
+	template <class _Type, class _Policy = void, class _Elem, class _Traits>
+	FieldsResult SplitAs(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, _Type* pvalues, size_t capacity, std::vector<FieldError>* perrors = nullptr) {
+		return detail::SplitAsTo<_Policy>(rstring, detail::MakeDelimFn<_Elem, _Traits>(delim), pvalues, capacity, perrors);
+	}
+	template <class _Type, class _Policy = void, class _Elem, class _Traits, class _Alloc>
+	FieldsResult SplitAs(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, std::vector<_Type, _Alloc>* presult, std::vector<FieldError>* perrors = nullptr) {
+		return detail::SplitAsTo<_Policy>(rstring, detail::MakeDelimFn<_Elem, _Traits>(delim), presult, perrors);
+	}
+	template <class _Type, class _Policy = void, class _Elem, class _Traits>
+	FieldsResult SplitAs(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, _Type* pvalues, size_t capacity, std::vector<FieldError>* perrors = nullptr) {
+		return detail::SplitAsTo<_Policy>(rstring, detail::MakeDelimFn<_Elem, _Traits>(delim), pvalues, capacity, perrors);
+	}
+	template <class _Type, class _Policy = void, class _Elem, class _Traits, class _Alloc, class _Delim, class... _Out>
+	FieldsResult SplitAs(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Delim delim, _Out... out) {
+		return SplitAs<_Type, _Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim, out...);
+	}
+	template <class _Type, class _Policy = void, class _Elem, class _Traits, class _Delim>
+	std::vector<_Type> SplitAs(std::basic_string_view<_Elem, _Traits> rstring, _Delim delim, FieldsResult* presult = nullptr) {
+		std::vector<_Type> lresult{};
+		auto result = SplitAs<_Type, _Policy>(rstring, delim, &lresult);
+		if (presult) {
+			*presult = result;
+		}
+		return lresult;
+	}
+	template <class _Type, class _Policy = void, class _Elem, class _Traits, class _Alloc, class _Delim>
+	std::vector<_Type> SplitAs(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Delim delim, FieldsResult* presult = nullptr) {
+		return SplitAs<_Type, _Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim, presult);
+	}
+	// Views into a temporary would dangle; numbers and strings may come from one.
+	template <class _Type, class _Policy = void, class _Elem, class _Traits, class _Alloc, class _Delim, class... _Out, detail::Enable_If_Views_t<_Type> = 0>
+	FieldsResult SplitAs(std::basic_string<_Elem, _Traits, _Alloc>&& rstring, _Delim delim, _Out... out) = delete;
+	template <class _Type, class _Policy = void, class _Elem, class _Traits, class _Alloc, class _Delim, detail::Enable_If_Views_t<_Type> = 0>
+	std::vector<_Type> SplitAs(std::basic_string<_Elem, _Traits, _Alloc>&& rstring, _Delim delim, FieldsResult* presult = nullptr) = delete;
+	// auto fields = cpp::ParseFields<int64_t, double, std::string_view>(line, ',');
+	// if (fields) { auto [id, value, name] = fields.values; }
+	template <class... _Types, class _Elem, class _Traits, class _Delim>
+	ParsedFields<_Types...> ParseFields(std::basic_string_view<_Elem, _Traits> line, _Delim delim) {
+		return detail::ParseFieldsAs<void, _Types...>(line, detail::MakeDelimFn<_Elem, _Traits>(delim), std::index_sequence_for<_Types...>{});
+	}
+	template <class... _Types, class _Elem, class _Traits, class _Alloc, class _Delim>
+	ParsedFields<_Types...> ParseFields(const std::basic_string<_Elem, _Traits, _Alloc>& line, _Delim delim) {
+		return ParseFields<_Types...>(std::basic_string_view<_Elem, _Traits>(line), delim);
+	}
+	// Trimmed with a Trim policy: ParseFields<int, double>(line, ',', cpp::AsciiSpace{}).
+	template <class... _Types, class _Elem, class _Traits, class _Delim, class _Policy, detail::Enable_If_Policy_t<_Policy> = 0>
+	ParsedFields<_Types...> ParseFields(std::basic_string_view<_Elem, _Traits> line, _Delim delim, _Policy) {
+		return detail::ParseFieldsAs<_Policy, _Types...>(line, detail::MakeDelimFn<_Elem, _Traits>(delim), std::index_sequence_for<_Types...>{});
+	}
+	template <class... _Types, class _Elem, class _Traits, class _Alloc, class _Delim, class _Policy, detail::Enable_If_Policy_t<_Policy> = 0>
+	ParsedFields<_Types...> ParseFields(const std::basic_string<_Elem, _Traits, _Alloc>& line, _Delim delim, _Policy policy) {
+		return ParseFields<_Types...>(std::basic_string_view<_Elem, _Traits>(line), delim, policy);
+	}
+	// Straight into existing objects: ParseFields(line, ',', &row.id, &row.value).
+	template <class... _Types, class _Elem, class _Traits, class _Delim>
+	FieldStatus<sizeof...(_Types)> ParseFields(std::basic_string_view<_Elem, _Traits> line, _Delim delim, _Types*... pvalues) {
+		return detail::ParseFieldsTo<void>(line, detail::MakeDelimFn<_Elem, _Traits>(delim), std::index_sequence_for<_Types...>{}, pvalues...);
+	}
+	template <class... _Types, class _Elem, class _Traits, class _Delim, class _Policy, detail::Enable_If_Policy_t<_Policy> = 0>
+	FieldStatus<sizeof...(_Types)> ParseFields(std::basic_string_view<_Elem, _Traits> line, _Delim delim, _Policy, _Types*... pvalues) {
+		return detail::ParseFieldsTo<_Policy>(line, detail::MakeDelimFn<_Elem, _Traits>(delim), std::index_sequence_for<_Types...>{}, pvalues...);
+	}
+	template <class... _Types, class _Elem, class _Traits, class _Alloc, class _Delim>
+	FieldStatus<sizeof...(_Types)> ParseFields(const std::basic_string<_Elem, _Traits, _Alloc>& line, _Delim delim, _Types*... pvalues) {
+		return ParseFields(std::basic_string_view<_Elem, _Traits>(line), delim, pvalues...);
+	}
+	template <class... _Types, class _Elem, class _Traits, class _Alloc, class _Delim, class _Policy, detail::Enable_If_Policy_t<_Policy> = 0>
+	FieldStatus<sizeof...(_Types)> ParseFields(const std::basic_string<_Elem, _Traits, _Alloc>& line, _Delim delim, _Policy policy, _Types*... pvalues) {
+		return ParseFields(std::basic_string_view<_Elem, _Traits>(line), delim, policy, pvalues...);
+	}
+	// As for SplitAs: no views into a temporary line.
+	template <class... _Types, class _Elem, class _Traits, class _Alloc, class _Delim, detail::Enable_If_Views_t<_Types...> = 0>
+	ParsedFields<_Types...> ParseFields(std::basic_string<_Elem, _Traits, _Alloc>&& line, _Delim delim) = delete;
+	template <class... _Types, class _Elem, class _Traits, class _Alloc, class _Delim, class _Policy, detail::Enable_If_Policy_t<_Policy> = 0, detail::Enable_If_Views_t<_Types...> = 0>
+	ParsedFields<_Types...> ParseFields(std::basic_string<_Elem, _Traits, _Alloc>&& line, _Delim delim, _Policy policy) = delete;
+	template <class... _Types, class _Elem, class _Traits, class _Alloc, class _Delim, detail::Enable_If_Views_t<_Types...> = 0>
+	FieldStatus<sizeof...(_Types)> ParseFields(std::basic_string<_Elem, _Traits, _Alloc>&& line, _Delim delim, _Types*... pvalues) = delete;
+	template <class... _Types, class _Elem, class _Traits, class _Alloc, class _Delim, class _Policy, detail::Enable_If_Policy_t<_Policy> = 0, detail::Enable_If_Views_t<_Types...> = 0>
+	FieldStatus<sizeof...(_Types)> ParseFields(std::basic_string<_Elem, _Traits, _Alloc>&& line, _Delim delim, _Policy policy, _Types*... pvalues) = delete;
+	// -------------------------------------------------------------------
+	// ParallelSplit.
+	// -------------------------------------------------------------------
+	struct ParallelOptions {
+		size_t threads{};						// 0: std::thread::hardware_concurrency().
+		size_t serialThreshold{ 1 << 20 };		// smaller inputs are split on the calling thread.
+		// Runs task(0) .. task(count - 1) and returns once all have finished.
+		// Empty: the calling thread plus threads - 1 std::threads pull tasks;
+		// they are started once per call and kept for both passes. Set this
+		// to run the tasks on an existing thread pool instead.
+		std::function<void(size_t count, const std::function<void(size_t)>& task)> executor;
+	};
+	namespace detail {
+		inline size_t ParallelThreads(const ParallelOptions& options) {
+			size_t threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+			return std::max<size_t>(threads, 1);
+		}
+		// Runs first(0 .. count - 1), then between() on the calling thread, then
+		// second(0 .. count - 1). Without an executor both passes share one set
+		// of threads, which wait for between() instead of being joined and
+		// started again.
+		inline void RunParallel(size_t count, const ParallelOptions& options, const std::function<void(size_t)>& first,
+			const std::function<void()>& between, const std::function<void(size_t)>& second) {
+			if (options.executor) {
+				options.executor(count, first);
+				between();
+				options.executor(count, second);
+				return;
+			}
+			std::atomic<size_t> next{};
+			std::exception_ptr error{};
+			std::atomic<bool> failed{};
+			auto run = [&](const std::function<void(size_t)>& task) {
+				for (size_t i = next++; i < count; i = next++) {
+					try {
+						task(i);
+					}
+					catch (...) {
+						if (!failed.exchange(true)) {
+							error = std::current_exception();
+						}
+					}
+				}
+			};
+			// pass: 0 first, 1 second, 2 stop; arrived counts workers done with the first.
+			std::mutex mutex;
+			std::condition_variable changed;
+			size_t pass{}, arrived{};
+			auto worker = [&] {
+				run(first);
+				std::unique_lock<std::mutex> lock(mutex);
+				++arrived;
+				changed.notify_all();
+				changed.wait(lock, [&] { return pass != 0; });
+				if (pass == 1) {
+					lock.unlock();
+					run(second);
+				}
+			};
+			std::vector<std::thread> threads;
+			auto release = [&](size_t to) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					pass = to;
+				}
+				changed.notify_all();
+			};
+			const size_t extra = std::min(ParallelThreads(options), count) - 1;
+			threads.reserve(extra);
+			try {
+				for (size_t i = 0; i < extra; ++i) {
+					threads.emplace_back(worker);
+				}
+				run(first);
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					changed.wait(lock, [&] { return arrived == threads.size(); });
+				}
+				if (error) {
+					std::rethrow_exception(error);
+				}
+				between();
+			}
+			catch (...) {
+				// no thread may be left joinable: hand out no more tasks and stop
+				// the workers at the barrier.
+				next = count;
+				release(2);
+				for (auto& thread : threads) {
+					thread.join();
+				}
+				throw;
+			}
+			next = 0;
+			release(1);
+			run(second);
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+		template<class _Trim, class _Elem, class _Traits, class _DelimFn, class _Result>
+		inline void SplitSerialTo(std::basic_string_view<_Elem, _Traits> rstring, const _DelimFn& fn, _Result* presult) {
+			auto& lresult = *presult;
+			ForEachToken<_Trim>(rstring, fn, [&](auto token) {
+				lresult.emplace_back(token);
+			});
+		}
+		template<class _Value, class _Elem, class _Traits>
+		inline void AssignToken(_Value* pvalue, std::basic_string_view<_Elem, _Traits> token) {
+			if constexpr (std::is_same<_Value, std::basic_string_view<_Elem, _Traits>>::value) {
+				*pvalue = token;
+			}
+			else {
+				pvalue->assign(token.data(), token.size());
+			}
+		}
+		// Ranges start right after a delimiter, so every range but the last ends
+		// with one and yields exactly one token per delimiter it contains.
+		template<class _Trim, class _Elem, class _Traits, class _DelimFn, class _Result>
+		inline void ParallelSplitTo(std::basic_string_view<_Elem, _Traits> rstring, const _DelimFn& fn, _Result* presult, const ParallelOptions& options) {
+			assert(presult);
+			Api_Probe probe(StringApi::ParallelSplit, rstring.size());
+			const size_t count = presult->size(), capacity = presult->capacity();
+			auto finish = [&] {
+				probe.Tokens(presult->size() - count);
+				probe.Grow(capacity, presult->capacity(), sizeof((*presult)[0]));
+			};
+			const size_t threads = ParallelThreads(options);
+			const size_t size = rstring.size();
+			if (threads < 2 || size < std::max<size_t>(options.serialThreshold, 1)) {
+				SplitSerialTo<_Trim>(rstring, fn, presult);
+				finish();
+				return;
+			}
+			// 1. cut into ranges, moved forward to just past a delimiter.
+			const auto data = rstring.data();
+			const size_t parts = threads * 4;
+			std::vector<size_t> bounds{ 0 };
+			for (size_t i = 1; i < parts; ++i) {
+				size_t cut = std::max(size / parts * i, bounds.back());
+				auto delim = fn(data + cut, data + size);
+				if (delim == data + size) {
+					break;
+				}
+				size_t bound = static_cast<size_t>(delim - data) + 1;
+				if (bound != bounds.back()) {
+					bounds.push_back(bound);
+				}
+			}
+			bounds.push_back(size);
+			const size_t ranges = bounds.size() - 1;
+			auto range = [&](size_t i) {
+				// drop the delimiter that closes the range; the last one keeps its tail.
+				size_t last = i + 1 < ranges ? bounds[i + 1] - 1 : bounds[i + 1];
+				return std::basic_string_view<_Elem, _Traits>(data + bounds[i], last - bounds[i]);
+			};
+			// 2. count tokens per range, 3. size the result, 4. write each range
+			// into its own slots.
+			std::vector<size_t> offsets(ranges + 1);
+			auto& lresult = *presult;
+			RunParallel(ranges, options, [&](size_t i) {
+				size_t count{};
+				ForEachToken<void>(range(i), fn, [&](auto) { ++count; });
+				offsets[i + 1] = count;
+			}, [&] {
+				offsets[0] = lresult.size();
+				for (size_t i = 0; i < ranges; ++i) {
+					offsets[i + 1] += offsets[i];
+				}
+				lresult.resize(offsets[ranges]);
+			}, [&](size_t i) {
+				size_t slot = offsets[i];
+				ForEachToken<_Trim>(range(i), fn, [&](auto token) {
+					AssignToken(&lresult[slot++], token);
+				});
+			});
+			finish();
+		}
+	}
+	// Same tokens, in the same order, as Split/SplitTrim, produced by
+	// several threads; output slots are filled in place.
+	template <class _Elem, class _Traits, class _OutAlloc, class _VecAlloc>
+	void ParallelSplit(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, std::vector<std::basic_string<_Elem, _Traits, _OutAlloc>, _VecAlloc>* presult, const ParallelOptions& options = {}) {
+		detail::ParallelSplitTo<void>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim), presult, options);
+	}
+	template <class _Elem, class _Traits, class _VecAlloc>
+	void ParallelSplit(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, std::vector<std::basic_string_view<_Elem, _Traits>, _VecAlloc>* presult, const ParallelOptions& options = {}) {
+		detail::ParallelSplitTo<void>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim), presult, options);
+	}
+	template <class _Elem, class _Traits, class _Alloc, class _Result>
+	void ParallelSplit(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, _Result* presult, const ParallelOptions& options = {}) {
+		ParallelSplit(std::basic_string_view<_Elem, _Traits>(rstring), delim, presult, options);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+	auto ParallelSplit(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, const ParallelOptions& options = {}) {
+		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
+		ParallelSplit(rstring, delim, &lresult, options);
+		return lresult;
+	}
+	template <class _Elem, class _Traits, class _OutAlloc, class _VecAlloc>
+	void ParallelSplit(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, std::vector<std::basic_string<_Elem, _Traits, _OutAlloc>, _VecAlloc>* presult, const ParallelOptions& options = {}) {
+		detail::ParallelSplitTo<void>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim), presult, options);
+	}
+	template <class _Elem, class _Traits, class _VecAlloc>
+	void ParallelSplit(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, std::vector<std::basic_string_view<_Elem, _Traits>, _VecAlloc>* presult, const ParallelOptions& options = {}) {
+		detail::ParallelSplitTo<void>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim), presult, options);
+	}
+	template <class _Elem, class _Traits, class _Alloc, class _Result>
+	void ParallelSplit(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, _Result* presult, const ParallelOptions& options = {}) {
+		ParallelSplit(std::basic_string_view<_Elem, _Traits>(rstring), delim, presult, options);
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+	auto ParallelSplit(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, const ParallelOptions& options = {}) {
+		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
+		ParallelSplit(rstring, delim, &lresult, options);
+		return lresult;
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _OutAlloc, class _VecAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void ParallelSplitTrim(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, std::vector<std::basic_string<_Elem, _Traits, _OutAlloc>, _VecAlloc>* presult, const ParallelOptions& options = {}) {
+		detail::ParallelSplitTo<_Policy>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim), presult, options);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _VecAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void ParallelSplitTrim(std::basic_string_view<_Elem, _Traits> rstring, _Elem delim, std::vector<std::basic_string_view<_Elem, _Traits>, _VecAlloc>* presult, const ParallelOptions& options = {}) {
+		detail::ParallelSplitTo<_Policy>(rstring, detail::Char_Delim_Fn<_Elem, _Traits>(delim), presult, options);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _Result, detail::Enable_If_Policy_t<_Policy> = 0>
+	void ParallelSplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, _Result* presult, const ParallelOptions& options = {}) {
+		ParallelSplitTrim<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim, presult, options);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto ParallelSplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, const ParallelOptions& options = {}) {
+		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
+		ParallelSplitTrim<_Policy>(rstring, delim, &lresult, options);
+		return lresult;
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _OutAlloc, class _VecAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void ParallelSplitTrim(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, std::vector<std::basic_string<_Elem, _Traits, _OutAlloc>, _VecAlloc>* presult, const ParallelOptions& options = {}) {
+		detail::ParallelSplitTo<_Policy>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim), presult, options);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _VecAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void ParallelSplitTrim(std::basic_string_view<_Elem, _Traits> rstring, const _Elem* delim, std::vector<std::basic_string_view<_Elem, _Traits>, _VecAlloc>* presult, const ParallelOptions& options = {}) {
+		detail::ParallelSplitTo<_Policy>(rstring, detail::Set_Delim_Fn<_Elem, _Traits>(delim), presult, options);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _Result, detail::Enable_If_Policy_t<_Policy> = 0>
+	void ParallelSplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, _Result* presult, const ParallelOptions& options = {}) {
+		ParallelSplitTrim<_Policy>(std::basic_string_view<_Elem, _Traits>(rstring), delim, presult, options);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto ParallelSplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, const ParallelOptions& options = {}) {
+		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
+		ParallelSplitTrim<_Policy>(rstring, delim, &lresult, options);
+		return lresult;
+	}
+	// -------------------------------------------------------------------
+	// StreamSplit.
+	// -------------------------------------------------------------------
+	// Chunk sources: Read fills up to count elements and returns 0 at the end;
+	// a read error throws rather than ending the stream early.
+	template <class _Elem, class _Traits = std::char_traits<_Elem>>
+	struct IstreamSource {
+		using value_type = _Elem;
+		std::basic_istream<_Elem, _Traits>* stream;
+
+		size_t Read(_Elem* dst, size_t count) {
+			assert(stream);
+			stream->read(dst, static_cast<std::streamsize>(count));
+			// badbit is an error in the stream buffer; eof and fail only end it.
+			if (stream->bad()) {
+				throw std::ios_base::failure("read");
+			}
+			return static_cast<size_t>(stream->gcount());
+		}
+	};
+	struct FdSource {
+		using value_type = char;
+		int fd;
+
+		size_t Read(char* dst, size_t count) {
+			while (true) {
+#if defined(_WIN32)
+				auto result = ::_read(fd, dst, static_cast<unsigned>(std::min<size_t>(count, INT_MAX)));
+#else
+				auto result = ::read(fd, dst, count);
+#endif
+				if (result >= 0) {
+					return static_cast<size_t>(result);
+				}
+				if (errno != EINTR) {
+					throw std::system_error(errno, std::generic_category(), "read");
+				}
+			}
+		}
+	};
+	template <class _Elem>
+	struct MemorySource {
+		using value_type = _Elem;
+		const _Elem* first;
+		const _Elem* last;
+
+		size_t Read(_Elem* dst, size_t count) {
+			count = std::min(count, static_cast<size_t>(last - first));
+			std::copy(first, first + count, dst);
+			first += count;
+			return count;
+		}
+	};
+#if defined(STRING_UTIL_POSIX)
+	// Read-only mapping of a whole file. Source() hands the pages back to the
+	// kernel once they are consumed, so RSS stays at about one chunk.
+	class MappedFile {
+	public:
+		struct Source {
+			using value_type = char;
+			const char* base;
+			size_t offset;
+			size_t size;
+			size_t released;
+
+			size_t Read(char* dst, size_t count) {
+				count = std::min(count, size - offset);
+				std::copy(base + offset, base + offset + count, dst);
+				offset += count;
+				static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+				size_t consumed = offset / page * page;
+				if (consumed > released) {
+					::madvise(const_cast<char*>(base) + released, consumed - released, MADV_DONTNEED);
+					released = consumed;
+				}
+				return count;
+			}
+		};
+
+		MappedFile() = default;
+		explicit MappedFile(const char* path) {
+			Open(path);
+		}
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() {
+			Close();
+		}
+		bool Open(const char* path) {
+			Close();
+			int fd = ::open(path, O_RDONLY);
+			if (fd < 0) {
+				return false;
+			}
+			struct stat info {};
+			if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+				auto mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+				if (mapped != MAP_FAILED) {
+					base = static_cast<const char*>(mapped);
+					length = static_cast<size_t>(info.st_size);
+					::madvise(mapped, length, MADV_SEQUENTIAL);
+				}
+			}
+			::close(fd);
+			return base != nullptr;
+		}
+		void Close() {
+			if (base) {
+				::munmap(const_cast<char*>(base), length);
+				base = nullptr;
+				length = 0;
+			}
+		}
+		const char* data() const {
+			return base;
+		}
+		size_t size() const {
+			return length;
+		}
+		Source source() const {
+			return Source{ base, 0, length, 0 };
+		}
+	private:
+		const char* base{};
+		size_t length{};
+	};
+#endif
+	// Single-pass tokenizer over a chunk source with Split/SplitTrim
+	// semantics. Only the unfinished tail of a chunk is carried over; the
+	// buffer grows only when one token is larger than a chunk. A token view
+	// is valid until the next token is read.
+	template <class _Elem, class _Traits, class _Source, class _DelimFn, class _Trim>
+	class BasicStreamSplitView {
+	public:
+		using value_type = std::basic_string_view<_Elem, _Traits>;
+		static constexpr size_t Default_Chunk_Size = 64 * 1024;
+
+		class iterator {
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = std::basic_string_view<_Elem, _Traits>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type*;
+			using reference = value_type;
+
+			iterator() = default;
+			reference operator*() const {
+				return token;
+			}
+			iterator& operator++() {
+				if (!splitter->Next(&token)) {
+					splitter = nullptr;
+				}
+				return *this;
+			}
+			bool operator==(const iterator& other) const {
+				return splitter == other.splitter;
+			}
+			bool operator!=(const iterator& other) const {
+				return splitter != other.splitter;
+			}
+		private:
+			friend class BasicStreamSplitView;
+			explicit iterator(BasicStreamSplitView* splitter) : splitter(splitter) {
+				++*this;
+			}
+
+			BasicStreamSplitView* splitter{};
+			value_type token{};
+		};
+
+		BasicStreamSplitView(_Source source, _DelimFn fn, size_t chunkSize = Default_Chunk_Size)
+			: source(std::move(source)), fn(std::move(fn)), buffer(std::max<size_t>(chunkSize, 1)) {}
+
+		iterator begin() {
+			return iterator(this);
+		}
+		iterator end() {
+			return iterator{};
+		}
+		bool Next(value_type* ptoken) {
+			assert(ptoken);
+			while (!done) {
+				auto data = buffer.data();
+				auto delim = fn(data + scan, data + filled);
+				if (delim != data + filled || eof) {
+					value_type token(data + first, static_cast<size_t>(delim - data) - first);
+					if constexpr (!std::is_void<_Trim>::value) {
+						token = detail::TrimToken<_Trim>(token);
+					}
+					*ptoken = token;
+					done = delim == data + filled;
+					first = scan = static_cast<size_t>(delim - data) + 1;
+					return true;
+				}
+				Refill();
+			}
+			return false;
+		}
+		// Elements read from the source so far.
+		size_t bytes_read() const {
+			return consumed;
+		}
+	private:
+		void Refill() {
+			// 1. keep only the unfinished token.
+			std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(first), buffer.begin() + static_cast<std::ptrdiff_t>(filled), buffer.begin());
+			filled -= first;
+			scan = filled;
+			first = 0;
+			// 2. a token longer than the buffer.
+			if (filled == buffer.size()) {
+				buffer.resize(buffer.size() * 2);
+			}
+			// 3. read.
+			auto count = source.Read(buffer.data() + filled, buffer.size() - filled);
+			filled += count;
+			consumed += count;
+			eof = count == 0;
+		}
+
+		_Source source;
+		_DelimFn fn;
+		std::vector<_Elem> buffer;
+		size_t first{};
+		size_t scan{};
+		size_t filled{};
+		size_t consumed{};
+		bool eof{};
+		bool done{};
+	};
+	namespace detail {
+		template <class _Source, std::enable_if_t<!std::is_base_of<std::ios_base, std::decay_t<_Source>>::value, int> = 0>
+		inline auto MakeStreamSource(_Source&& source) {
+			return std::decay_t<_Source>(std::forward<_Source>(source));
+		}
+		template <class _Elem, class _Traits>
+		inline auto MakeStreamSource(std::basic_istream<_Elem, _Traits>& stream) {
+			return IstreamSource<_Elem, _Traits>{ &stream };
+		}
+		template <class _Trim, class _Source, class _Elem, class _Delim>
+		auto MakeStreamSplitView(_Source&& source, _Delim delim, size_t chunkSize) {
+			using _Traits = std::char_traits<_Elem>;
+			using _Chunks = decltype(MakeStreamSource(std::forward<_Source>(source)));
+			using _DelimFn = std::conditional_t<std::is_pointer<_Delim>::value, Set_Delim_Fn<_Elem, _Traits>, Char_Delim_Fn<_Elem, _Traits>>;
+			static_assert(std::is_same<typename _Chunks::value_type, _Elem>::value, "delimiter type does not match the source.");
+			return BasicStreamSplitView<_Elem, _Traits, _Chunks, _DelimFn, _Trim>(MakeStreamSource(std::forward<_Source>(source)), _DelimFn(delim), chunkSize);
+		}
+	}
+	// source: a std::istream, FdSource, MemorySource, MappedFile::Source or any
+	// type with value_type and size_t Read(value_type*, size_t).
+	template <class _Source, class _Elem>
+	auto StreamSplitView(_Source&& source, _Elem delim, size_t chunkSize = 64 * 1024) {
+		return detail::MakeStreamSplitView<void, _Source, _Elem>(std::forward<_Source>(source), delim, chunkSize);
+	}
+	template <class _Source, class _Elem>
+	auto StreamSplitView(_Source&& source, const _Elem* delim, size_t chunkSize = 64 * 1024) {
+		return detail::MakeStreamSplitView<void, _Source, _Elem>(std::forward<_Source>(source), delim, chunkSize);
+	}
+	template <class _Policy = SpaceOnly, class _Source, class _Elem, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto StreamSplitTrimView(_Source&& source, _Elem delim, size_t chunkSize = 64 * 1024) {
+		return detail::MakeStreamSplitView<_Policy, _Source, _Elem>(std::forward<_Source>(source), delim, chunkSize);
+	}
+	template <class _Policy = SpaceOnly, class _Source, class _Elem, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto StreamSplitTrimView(_Source&& source, const _Elem* delim, size_t chunkSize = 64 * 1024) {
+		return detail::MakeStreamSplitView<_Policy, _Source, _Elem>(std::forward<_Source>(source), delim, chunkSize);
+	}
+	// Calls fn(basic_string_view) for every token; returns the token count.
+	template <class _Source, class _Delim, class _Fn>
+	size_t StreamSplit(_Source&& source, _Delim delim, _Fn&& fn, size_t chunkSize = 64 * 1024) {
+		detail::Api_Probe probe(StringApi::StreamSplit, 0);
+		size_t count{}, bytes{};
+		auto view = StreamSplitView(std::forward<_Source>(source), delim, chunkSize);
+		for (auto token : view) {
+			fn(token);
+			bytes += token.size();
+			++count;
+		}
+		probe.In(view.bytes_read());
+		probe.Tokens(count);
+		probe.Out(bytes);
+		return count;
+	}
+	template <class _Policy = SpaceOnly, class _Source, class _Delim, class _Fn, detail::Enable_If_Policy_t<_Policy> = 0>
+	size_t StreamSplitTrim(_Source&& source, _Delim delim, _Fn&& fn, size_t chunkSize = 64 * 1024) {
+		detail::Api_Probe probe(StringApi::StreamSplit, 0);
+		size_t count{}, bytes{};
+		auto view = StreamSplitTrimView<_Policy>(std::forward<_Source>(source), delim, chunkSize);
+		for (auto token : view) {
+			fn(token);
+			bytes += token.size();
+			++count;
+		}
+		probe.In(view.bytes_read());
+		probe.Tokens(count);
+		probe.Out(bytes);
+		return count;
+	}
+	// -------------------------------------------------------------------
+	// Csv.
+	// -------------------------------------------------------------------
+	namespace detail {
+		inline bool DetectPclmul() {
+#if defined(STRING_UTIL_X86)
+#if defined(_MSC_VER)
+			int info[4]{};
+			__cpuid(info, 1);
+			return (info[2] & (1 << 1)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("pclmul");
+#endif
+#else
+			return false;
+#endif
+		}
+		inline bool HasPclmul() {
+			static const bool pclmul = DetectPclmul();
+			return pclmul;
+		}
+		struct Csv_Masks {
+			uint64_t quote;
+			uint64_t delim;
+			uint64_t newline;
+		};
+		// Stage one of the CSV reader: 64 bytes at a time, the quote bits are
+		// turned into an inside-quotes mask by a prefix XOR (carry-less multiply
+		// by all ones when PCLMUL is there) and delimiters under it are dropped.
+		struct Csv_Scanner {
+			char delim;
+			char quote;
+			void (*kernel)(const Csv_Scanner&, const char*, size_t, uint64_t*, std::vector<uint64_t>*){};
+
+			Csv_Scanner(char delim, char quote, SimdLevel level = CurrentSimdLevel(), bool pclmul = HasPclmul())
+				: delim(delim), quote(quote) {
+				kernel = &IndexScalar;
+#if defined(STRING_UTIL_X86)
+				if (pclmul && level == SimdLevel::Avx2) {
+					kernel = &IndexAvx2;
+				}
+				else if (pclmul && level == SimdLevel::Sse2) {
+					kernel = &IndexClmul;
+				}
+				else if (level != SimdLevel::Scalar) {
+					kernel = &IndexSse2;
+				}
+#else
+				(void)level;
+				(void)pclmul;
+#endif
+			}
+			// Appends (position << 1 | is_newline) for every delimiter and '\n'
+			// outside quotes. *pinside is all ones while inside quotes.
+			void operator()(const char* data, size_t size, uint64_t* pinside, std::vector<uint64_t>* out) const {
+				kernel(*this, data, size, pinside, out);
+			}
+
+			static int FirstBit(uint64_t mask) {
+#if defined(_MSC_VER) && defined(_M_X64)
+				unsigned long index;
+				_BitScanForward64(&index, mask);
+				return static_cast<int>(index);
+#elif defined(_MSC_VER)
+				unsigned long index;
+				if (_BitScanForward(&index, static_cast<unsigned long>(mask))) {
+					return static_cast<int>(index);
+				}
+				_BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+				return static_cast<int>(index) + 32;
+#else
+				return __builtin_ctzll(mask);
+#endif
+			}
+			static int Popcount(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+				return __builtin_popcountll(mask);
+#else
+				mask -= (mask >> 1) & 0x5555555555555555ull;
+				mask = (mask & 0x3333333333333333ull) + ((mask >> 2) & 0x3333333333333333ull);
+				mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+				return static_cast<int>((mask * 0x0101010101010101ull) >> 56);
+#endif
+			}
+			struct Scalar_Block {
+				static Csv_Masks Masks(const Csv_Scanner& scanner, const char* block) {
+					Csv_Masks masks{};
+					for (int i = 0; i < 64; ++i) {
+						const uint64_t bit = uint64_t{ 1 } << i;
+						masks.quote |= block[i] == scanner.quote ? bit : 0;
+						masks.delim |= block[i] == scanner.delim ? bit : 0;
+						masks.newline |= block[i] == '\n' ? bit : 0;
+					}
+					return masks;
+				}
+				static uint64_t PrefixXor(uint64_t bits) {
+					bits ^= bits << 1;
+					bits ^= bits << 2;
+					bits ^= bits << 4;
+					bits ^= bits << 8;
+					bits ^= bits << 16;
+					bits ^= bits << 32;
+					return bits;
+				}
+			};
+			template<class _Block>
+			static void IndexBlocks(const Csv_Scanner& scanner, const char* data, size_t size, uint64_t* pinside, std::vector<uint64_t>* out) {
+				uint64_t inside = *pinside;
+				// written through a pointer; out grows geometrically, then is cut to count.
+				size_t count = out->size();
+				auto step = [&](size_t base, const Csv_Masks& masks, uint64_t valid) {
+					const uint64_t quoted = _Block::PrefixXor(masks.quote & valid) ^ inside;
+					inside = static_cast<uint64_t>(static_cast<int64_t>(quoted) >> 63);
+					uint64_t separators = (masks.delim | masks.newline) & ~quoted & valid;
+					if (out->size() - count < 64) {
+						out->resize(std::max<size_t>(out->size() * 2, count + 64));
+					}
+					// four at a time without a data dependent branch; extra slots are overwritten later.
+					uint64_t* pos = out->data() + count;
+					const int total = Popcount(separators);
+					for (int i = 0; i < total; i += 4) {
+						for (int j = 0; j < 4; ++j) {
+							const int bit = FirstBit(separators | uint64_t{ 1 } << 63);
+							pos[i + j] = (base + static_cast<uint64_t>(bit)) << 1 | ((masks.newline >> bit) & 1);
+							separators &= separators - 1;
+						}
+					}
+					count += static_cast<size_t>(total);
+				};
+				size_t pos = 0;
+				for (; size - pos >= 64; pos += 64) {
+					step(pos, _Block::Masks(scanner, data + pos), ~uint64_t{});
+				}
+				if (pos != size) {
+					char tail[64]{};
+					std::memcpy(tail, data + pos, size - pos);
+					step(pos, _Block::Masks(scanner, tail), (uint64_t{ 1 } << (size - pos)) - 1);
+				}
+				out->resize(count);
+				*pinside = inside;
+			}
+			static void IndexScalar(const Csv_Scanner& scanner, const char* data, size_t size, uint64_t* pinside, std::vector<uint64_t>* out) {
+				IndexBlocks<Scalar_Block>(scanner, data, size, pinside, out);
+			}
+#if defined(STRING_UTIL_X86)
+			struct Sse2_Block : Scalar_Block {
+				static Csv_Masks Masks(const Csv_Scanner& scanner, const char* block) {
+					const __m128i quote = _mm_set1_epi8(scanner.quote);
+					const __m128i delim = _mm_set1_epi8(scanner.delim);
+					const __m128i newline = _mm_set1_epi8('\n');
+					Csv_Masks masks{};
+					for (int i = 0; i < 4; ++i) {
+						__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+						masks.quote |= uint64_t{ static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))) } << (16 * i);
+						masks.delim |= uint64_t{ static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delim))) } << (16 * i);
+						masks.newline |= uint64_t{ static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline))) } << (16 * i);
+					}
+					return masks;
+				}
+			};
+			struct Clmul_Block : Sse2_Block {
+				STRING_UTIL_TARGET_PCLMUL
+				static uint64_t PrefixXor(uint64_t bits) {
+					__m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(bits)), _mm_set1_epi8(-1), 0);
+					uint64_t result;
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(&result), product);
+					return result;
+				}
+			};
+			struct Avx2_Block : Clmul_Block {
+				STRING_UTIL_TARGET_AVX2
+				static Csv_Masks Masks(const Csv_Scanner& scanner, const char* block) {
+					const __m256i quote = _mm256_set1_epi8(scanner.quote);
+					const __m256i delim = _mm256_set1_epi8(scanner.delim);
+					const __m256i newline = _mm256_set1_epi8('\n');
+					Csv_Masks masks{};
+					for (int i = 0; i < 2; ++i) {
+						__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+						masks.quote |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote))) } << (32 * i);
+						masks.delim |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, delim))) } << (32 * i);
+						masks.newline |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline))) } << (32 * i);
+					}
+					return masks;
+				}
+			};
+			static void IndexSse2(const Csv_Scanner& scanner, const char* data, size_t size, uint64_t* pinside, std::vector<uint64_t>* out) {
+				IndexBlocks<Sse2_Block>(scanner, data, size, pinside, out);
+			}
+			STRING_UTIL_TARGET_PCLMUL
+			static void IndexClmul(const Csv_Scanner& scanner, const char* data, size_t size, uint64_t* pinside, std::vector<uint64_t>* out) {
+				IndexBlocks<Clmul_Block>(scanner, data, size, pinside, out);
+			}
+			STRING_UTIL_TARGET_AVX2_PCLMUL
+			static void IndexAvx2(const Csv_Scanner& scanner, const char* data, size_t size, uint64_t* pinside, std::vector<uint64_t>* out) {
+				IndexBlocks<Avx2_Block>(scanner, data, size, pinside, out);
+			}
+#endif
+		};
+	}
+	struct CsvDialect {
+		char delimiter{ ',' };
+		char quote{ '"' };
+	};
+	// One field; views point into the source. A quoted field holds its text
+	// without the enclosing quotes, and "" pairs are only undone on request.
+	class CsvField {
+	public:
+		CsvField() = default;
+		CsvField(std::string_view raw, char quote) : rawText(raw), text(raw), quote(quote) {
+			if (raw.size() >= 2 && raw.front() == quote && raw.back() == quote) {
+				text = raw.substr(1, raw.size() - 2);
+				isQuoted = true;
+			}
+		}
+		// As in the source, quotes included.
+		std::string_view raw() const {
+			return rawText;
+		}
+		std::string_view view() const {
+			return text;
+		}
+		bool quoted() const {
+			return isQuoted;
+		}
+		// view() still holds "" pairs.
+		bool escaped() const {
+			return isQuoted && text.find(quote) != text.npos;
+		}
+		// view() itself unless it needs unescaping into *pscratch.
+		std::string_view value(std::string* pscratch) const {
+			if (!escaped()) {
+				return text;
+			}
+			assert(pscratch);
+			pscratch->clear();
+			Unescape(pscratch);
+			return *pscratch;
+		}
+		std::string str() const {
+			std::string result{};
+			result.reserve(text.size());
+			Unescape(&result);
+			return result;
+		}
+	private:
+		void Unescape(std::string* presult) const {
+			size_t pos = 0;
+			while (true) {
+				size_t found = isQuoted ? text.find(quote, pos) : text.npos;
+				if (found == text.npos || found + 1 == text.size()) {
+					presult->append(text.data() + pos, text.size() - pos);
+					return;
+				}
+				presult->append(text.data() + pos, found + 1 - pos);
+				pos = found + (text[found + 1] == quote ? 2 : 1);
+			}
+		}
+
+		std::string_view rawText{};
+		std::string_view text{};
+		char quote{ '"' };
+		bool isQuoted{};
+	};
+	template <class _Policy>
+	class BasicCsvView;
+	// Fields of one record, by index or in order.
+	template <class _Policy>
+	class BasicCsvRow {
+	public:
+		using value_type = CsvField;
+
+		class iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = CsvField;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type*;
+			using reference = value_type;
+
+			iterator() = default;
+			reference operator*() const {
+				return (*row)[index];
+			}
+			iterator& operator++() {
+				++index;
+				return *this;
+			}
+			iterator operator++(int) {
+				auto prev = *this;
+				++index;
+				return prev;
+			}
+			bool operator==(const iterator& other) const {
+				return index == other.index;
+			}
+			bool operator!=(const iterator& other) const {
+				return index != other.index;
+			}
+		private:
+			friend class BasicCsvRow;
+			iterator(const BasicCsvRow* row, size_t index) : row(row), index(index) {}
+
+			const BasicCsvRow* row{};
+			size_t index{};
+		};
+
+		BasicCsvRow() = default;
+
+		size_t size() const {
+			return count;
+		}
+		bool empty() const {
+			return count == 0;
+		}
+		CsvField operator[](size_t index) const {
+			assert(index < count);
+			size_t first = index ? static_cast<size_t>(separators[index - 1] >> 1) + 1 : start;
+			size_t last = static_cast<size_t>(separators[index] >> 1);
+			if ((separators[index] & 1) && last > first && data[last - 1] == '\r') {
+				--last;
+			}
+			std::string_view raw(data + first, last - first);
+			if constexpr (!std::is_void<_Policy>::value) {
+				raw = detail::TrimToken<_Policy>(raw);
+			}
+			return CsvField(raw, quote);
+		}
+		iterator begin() const {
+			return iterator(this, 0);
+		}
+		iterator end() const {
+			return iterator(this, count);
+		}
+	private:
+		friend class BasicCsvView<_Policy>;
+		BasicCsvRow(const char* data, const uint64_t* separators, size_t start, size_t count, char quote)
+			: data(data), separators(separators), start(start), count(count), quote(quote) {}
+
+		const char* data{};
+		const uint64_t* separators{};
+		size_t start{};
+		size_t count{};
+		char quote{};
+	};
+	// RFC 4180 reader: quoted fields may hold delimiters, "" and newlines;
+	// rows end at LF or CRLF and blank lines are skipped. _Policy trims
+	// every field before quotes are looked at (void: no trimming). The
+	// source is indexed once on construction and must outlive the view.
+	template <class _Policy = void>
+	class BasicCsvView {
+	public:
+		using value_type = BasicCsvRow<_Policy>;
+
+		class iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = BasicCsvRow<_Policy>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type*;
+			using reference = const value_type&;
+
+			iterator() = default;
+			reference operator*() const {
+				return row;
+			}
+			pointer operator->() const {
+				return &row;
+			}
+			iterator& operator++() {
+				Advance();
+				return *this;
+			}
+			iterator operator++(int) {
+				auto prev = *this;
+				Advance();
+				return prev;
+			}
+			bool operator==(const iterator& other) const {
+				return next == other.next && done == other.done;
+			}
+			bool operator!=(const iterator& other) const {
+				return !(*this == other);
+			}
+		private:
+			friend class BasicCsvView;
+			explicit iterator(const BasicCsvView* view) : view(view), done(false) {
+				Advance();
+			}
+			void Advance() {
+				const auto& separators = view->separators;
+				while (next < separators.size()) {
+					size_t first = next ? static_cast<size_t>(separators[next - 1] >> 1) + 1 : 0;
+					size_t last = next;
+					while (!(separators[last] & 1)) {
+						++last;
+					}
+					size_t end = static_cast<size_t>(separators[last] >> 1);
+					size_t index = next;
+					next = last + 1;
+					if (last == index && (end == first || (end == first + 1 && view->source[first] == '\r'))) {
+						continue;
+					}
+					row = value_type(view->source.data(), separators.data() + index, first, last + 1 - index, view->dialect.quote);
+					return;
+				}
+				next = 0;
+				done = true;
+			}
+
+			const BasicCsvView* view{};
+			value_type row{};
+			size_t next{};
+			bool done{ true };
+		};
+
+		explicit BasicCsvView(std::string_view source, CsvDialect dialect = {}) {
+			assign(source, dialect);
+		}
+
+		// Indexes another source; the index keeps its capacity.
+		void assign(std::string_view source, CsvDialect dialect = {}) {
+			detail::Api_Probe probe(StringApi::Csv, source.size());
+			const size_t capacity = separators.capacity();
+			this->source = source;
+			this->dialect = dialect;
+			separators.clear();
+			detail::Csv_Scanner scanner(dialect.delimiter, dialect.quote);
+			uint64_t inside{};
+			scanner(source.data(), source.size(), &inside, &separators);
+			balanced = inside == 0;
+			// the last record needs a terminator too.
+			const uint64_t final = uint64_t{ source.size() } << 1 | 1;
+			if (!source.empty() && (separators.empty() || separators.back() != final - 2)) {
+				separators.push_back(final);
+			}
+			probe.Tokens(separators.size());
+			probe.Grow(capacity, separators.capacity(), sizeof(separators[0]));
+		}
+
+		iterator begin() const {
+			return iterator(this);
+		}
+		iterator end() const {
+			return iterator{};
+		}
+		// false when the source ends inside a quoted field.
+		bool ok() const {
+			return balanced;
+		}
+	private:
+		std::string_view source{};
+		CsvDialect dialect{};
+		std::vector<uint64_t> separators{};
+		bool balanced{};
+	};
+	// for (auto& row : cpp::CsvView(text)) for (auto field : row) field.view();
+	// TSV: cpp::CsvView(text, { '\t' }); trimmed: cpp::CsvView<cpp::AsciiSpace>(text).
+	template <class _Policy = void>
+	auto CsvView(std::string_view source, CsvDialect dialect = {}) {
+		return BasicCsvView<_Policy>(source, dialect);
+	}
+	template <class _Policy = void, class _Alloc>
+	auto CsvView(const std::basic_string<char, std::char_traits<char>, _Alloc>& source, CsvDialect dialect = {}) {
+		return BasicCsvView<_Policy>(std::string_view(source), dialect);
+	}
+	template <class _Policy = void, class _Alloc>
+	void CsvView(std::basic_string<char, std::char_traits<char>, _Alloc>&& source, CsvDialect dialect = {}) = delete;
+	// -------------------------------------------------------------------
+	// MultiMatcher.
+	// -------------------------------------------------------------------
+	struct MatchOptions {
+		bool ignoreCase{};		// compares through To_Lower_Fn<char>.
+	};
+	struct MultiMatch {
+		size_t position;
+		size_t length;
+		size_t pattern;			// index of the needle.
+	};
+	namespace detail {
+		// Aho-Corasick automaton compiled to a dense DFA over byte classes;
+		// bytes that occur in no needle share class 0.
+		class Aho_Corasick {
+		public:
+			// Largest first-byte set that is worth a SIMD jump from the root. The
+			// SSE2 kernel compares against up to 16 bytes one by one; the AVX2
+			// kernel tests any set through its nibble tables, and stops paying
+			// off only once most byte values can start a match.
+			static constexpr size_t Prefilter_Limit = 16;
+			static constexpr size_t Prefilter_Limit_Avx2 = 128;
+
+			explicit Aho_Corasick(const std::vector<std::string_view>& needles, bool ignoreCase) {
+				unsigned char fold[256];
+				for (unsigned ch = 0; ch < 256; ++ch) {
+					fold[ch] = ignoreCase ? static_cast<unsigned char>(To_Lower_Fn<char>{}(static_cast<char>(ch))) : static_cast<unsigned char>(ch);
+				}
+				// 1. byte classes.
+				bool used[256]{};
+				for (auto needle : needles) {
+					for (char ch : needle) {
+						used[fold[static_cast<unsigned char>(ch)]] = true;
+					}
+				}
+				uint8_t folded[256]{};
+				classes = 1;
+				for (unsigned ch = 0; ch < 256; ++ch) {
+					if (used[ch]) {
+						folded[ch] = static_cast<uint8_t>(classes++);
+					}
+				}
+				for (unsigned ch = 0; ch < 256; ++ch) {
+					classOf[ch] = folded[fold[ch]];
+				}
+				// 2. trie.
+				const uint32_t none = UINT32_MAX;
+				next.assign(classes, none);
+				terminal.assign(1, none);
+				depths.assign(1, 0);
+				lengths.reserve(needles.size());
+				bool firstClass[256]{};
+				for (size_t index = 0; index < needles.size(); ++index) {
+					auto needle = needles[index];
+					lengths.push_back(needle.size());
+					if (needle.empty()) {
+						continue;
+					}
+					firstClass[classOf[static_cast<unsigned char>(needle[0])]] = true;
+					uint32_t state = 0;
+					for (char ch : needle) {
+						const size_t edge = state * classes + classOf[static_cast<unsigned char>(ch)];
+						if (next[edge] == none) {
+							next[edge] = static_cast<uint32_t>(terminal.size());
+							terminal.push_back(none);
+							depths.push_back(depths[state] + 1);
+							next.resize(next.size() + classes, none);
+						}
+						state = next[edge];
+					}
+					if (terminal[state] == none) {
+						terminal[state] = static_cast<uint32_t>(index);
+					}
+				}
+				// 3. failure links, breadth first, folded into the transitions.
+				const size_t states = terminal.size();
+				std::vector<uint32_t> fail(states, 0);
+				output.assign(states, 0);
+				chain.assign(states, 0);
+				std::vector<uint32_t> queue;
+				queue.reserve(states);
+				for (size_t c = 0; c < classes; ++c) {
+					auto& target = next[c];
+					if (target == none) {
+						target = 0;
+					}
+					else {
+						queue.push_back(target);
+					}
+				}
+				for (size_t head = 0; head < queue.size(); ++head) {
+					const uint32_t state = queue[head];
+					output[state] = terminal[state] != none ? state : output[fail[state]];
+					chain[state] = output[fail[state]];
+					for (size_t c = 0; c < classes; ++c) {
+						auto& target = next[state * classes + c];
+						const uint32_t fallback = next[fail[state] * classes + c];
+						if (target == none) {
+							target = fallback;
+						}
+						else {
+							fail[target] = fallback;
+							queue.push_back(target);
+						}
+					}
+				}
+				// 4. prefilter on the bytes a match can start with.
+				char starts[256];
+				size_t count{};
+				for (unsigned ch = 0; ch < 256; ++ch) {
+					if (classOf[ch] && firstClass[classOf[ch]]) {
+						starts[count++] = static_cast<char>(ch);
+					}
+				}
+				if (count <= (CurrentSimdLevel() == SimdLevel::Avx2 ? Prefilter_Limit_Avx2 : Prefilter_Limit)) {
+					prefilter = Byte_Scanner(starts, count);
+					usePrefilter = true;
+				}
+			}
+
+			size_t size() const {
+				return lengths.size();
+			}
+			// fn(end, pattern) for every occurrence, ordered by end; return false to stop.
+			template<class _Fn>
+			void Scan(const char* first, const char* last, _Fn&& fn) const {
+				const auto begin = first;
+				uint32_t state = 0;
+				while (first != last) {
+					if (state == 0 && usePrefilter) {
+						first = prefilter(first, last);
+						if (first == last) {
+							return;
+						}
+					}
+					state = next[state * classes + classOf[static_cast<unsigned char>(*first)]];
+					++first;
+					for (uint32_t match = output[state]; match; match = chain[match]) {
+						if (!fn(static_cast<size_t>(first - begin), static_cast<size_t>(terminal[match]))) {
+							return;
+						}
+					}
+				}
+			}
+			// fn(position, pattern) for the leftmost-longest matches, without
+			// overlaps, in text order. The best candidate so far is final once no
+			// later match can start at or before it: the current state only spans
+			// the last depth bytes. Scanning then restarts at the candidate's end,
+			// so at most one needle length is read twice per match.
+			template<class _Fn>
+			void ScanLongest(const char* first, const char* last, _Fn&& fn) const {
+				const auto begin = first;
+				const uint32_t none = UINT32_MAX;
+				uint32_t state = 0;
+				uint32_t pattern = none;
+				size_t start{};
+				while (true) {
+					if (pattern != none && (first == last || static_cast<size_t>(first - begin) - depths[state] > start)) {
+						fn(start, static_cast<size_t>(pattern));
+						first = begin + start + lengths[pattern];
+						state = 0;
+						pattern = none;
+						continue;
+					}
+					if (state == 0 && usePrefilter) {
+						first = prefilter(first, last);
+					}
+					if (first == last) {
+						return;
+					}
+					state = next[state * classes + classOf[static_cast<unsigned char>(*first)]];
+					++first;
+					// longest first on the output chain.
+					for (uint32_t match = output[state]; match; match = chain[match]) {
+						const size_t length = lengths[terminal[match]];
+						const size_t position = static_cast<size_t>(first - begin) - length;
+						if (pattern == none || position < start || (position == start && length > lengths[pattern])) {
+							start = position;
+							pattern = terminal[match];
+						}
+					}
+				}
+			}
+			size_t Length(size_t pattern) const {
+				return lengths[pattern];
+			}
+		private:
+			size_t classes{};
+			uint8_t classOf[256]{};
+			std::vector<uint32_t> next{};
+			std::vector<uint32_t> terminal{};	// pattern ending at a state, UINT32_MAX for none.
+			std::vector<uint32_t> output{};		// first state with a pattern on the failure chain, 0 for none.
+			std::vector<uint32_t> chain{};		// the one after it.
+			std::vector<uint32_t> depths{};		// trie depth of each state.
+			std::vector<size_t> lengths{};
+			Byte_Scanner prefilter{ "", 0 };
+			bool usePrefilter{};
+		};
+		// FindAll without a probe, for callers that count themselves.
+		template <class _Alloc>
+		inline void FindLongestTo(const Aho_Corasick& automaton, std::string_view text, std::vector<MultiMatch, _Alloc>* presult) {
+			auto& lresult = *presult;
+			automaton.ScanLongest(text.data(), text.data() + text.size(), [&](size_t position, size_t pattern) {
+				lresult.push_back(MultiMatch{ position, automaton.Length(pattern), pattern });
+			});
+		}
+	}
+	// Set of needles compiled once, searched in one pass over the text.
+	class MultiMatcher {
+	public:
+		template <class _Range>
+		explicit MultiMatcher(const _Range& needles, MatchOptions options = {})
+			: automaton(ToViews(needles), options.ignoreCase) {}
+		MultiMatcher(std::initializer_list<std::string_view> needles, MatchOptions options = {})
+			: automaton(std::vector<std::string_view>(needles), options.ignoreCase) {}
+
+		size_t size() const {
+			return automaton.size();
+		}
+		// fn(MultiMatch) for every occurrence, overlapping ones included, in
+		// order of their end; fn may return false to stop.
+		template <class _Fn>
+		void ForEach(std::string_view text, _Fn&& fn) const {
+			detail::Api_Probe probe(StringApi::MultiMatch, text.size());
+			size_t count{};
+			automaton.Scan(text.data(), text.data() + text.size(), [&](size_t end, size_t pattern) {
+				const size_t length = automaton.Length(pattern);
+				++count;
+				if constexpr (std::is_same<decltype(fn(MultiMatch{})), bool>::value) {
+					return fn(MultiMatch{ end - length, length, pattern });
+				}
+				else {
+					fn(MultiMatch{ end - length, length, pattern });
+					return true;
+				}
+			});
+			probe.Tokens(count);
+		}
+		bool Contains(std::string_view text) const {
+			detail::Api_Probe probe(StringApi::MultiMatch, text.size());
+			bool found{};
+			automaton.Scan(text.data(), text.data() + text.size(), [&](size_t, size_t) {
+				found = true;
+				return false;
+			});
+			return found;
+		}
+		// Leftmost-longest, non-overlapping matches in text order; chosen
+		// during the scan, so only the kept matches are stored.
+		template <class _Alloc>
+		void FindAll(std::string_view text, std::vector<MultiMatch, _Alloc>* presult) const {
+			assert(presult);
+			auto& lresult = *presult;
+			detail::Api_Probe probe(StringApi::MultiMatch, text.size());
+			const size_t count = lresult.size(), capacity = lresult.capacity();
+			detail::FindLongestTo(automaton, text, presult);
+			probe.Tokens(lresult.size() - count);
+			probe.Grow(capacity, lresult.capacity(), sizeof(MultiMatch));
+		}
+		std::vector<MultiMatch> FindAll(std::string_view text) const {
+			std::vector<MultiMatch> lresult{};
+			FindAll(text, &lresult);
+			return lresult;
+		}
+	private:
+		friend class MultiReplacer;
+
+		template <class _Range>
+		static std::vector<std::string_view> ToViews(const _Range& needles) {
+			std::vector<std::string_view> views;
+			for (const auto& needle : needles) {
+				views.emplace_back(needle);
 			}
-		};
-		template<>
-		struct To_Upper_Fn<wchar_t> {
-			auto operator()(wchar_t ch) {
-				return towupper(ch);
+			return views;
+		}
+
+		detail::Aho_Corasick automaton;
+	};
+	// Needle -> replacement table applied in one pass: matches are chosen
+	// leftmost-longest, the output is sized once and filled by copies.
+	class MultiReplacer {
+	public:
+		template <class _Range>
+		explicit MultiReplacer(const _Range& pairs, MatchOptions options = {})
+			: matcher(Needles(pairs), options) {
+			for (const auto& pair : pairs) {
+				replacements.push_back(std::string_view(std::get<1>(pair)));
 			}
-		};
-		// -------------------------------------------------------------------
-		// Arg Parsing.
-		// -------------------------------------------------------------------
-		template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-		struct StringArgGroup {
-			std::vector<std::basic_string<_Elem, _Traits, _Alloc>> result;
-			size_t totalCapacity;
-		};
-		template<class _Traits = std::char_traits<char>, class _Alloc = std::allocator<char>>
-		inline auto ReadArgTo(StringArgGroup<char, _Traits, _Alloc>* group, int arg) {
-			assert(group);
-			auto value = std::to_string(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<class _Traits = std::char_traits<char>, class _Alloc = std::allocator<char>>
-		inline auto ReadArgTo(StringArgGroup<char, _Traits, _Alloc>* group, long arg) {
-			assert(group);
-			auto value = std::to_string(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<class _Traits = std::char_traits<char>, class _Alloc = std::allocator<char>>
-		inline auto ReadArgTo(StringArgGroup<char, _Traits, _Alloc>* group, float arg) {
-			assert(group);
-			auto value = std::to_string(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<class _Traits = std::char_traits<char>, class _Alloc = std::allocator<char>>
-		inline auto ReadArgTo(StringArgGroup<char, _Traits, _Alloc>* group, double arg) {
-			assert(group);
-			auto value = std::to_string(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<class _Traits = std::char_traits<wchar_t>, class _Alloc = std::allocator<wchar_t>>
-		inline auto ReadArgTo(StringArgGroup<wchar_t, _Traits, _Alloc>* group, int arg) {
-			assert(group);
-			auto value = std::to_wstring(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<class _Traits = std::char_traits<wchar_t>, class _Alloc = std::allocator<wchar_t>>
-		inline auto ReadArgTo(StringArgGroup<wchar_t, _Traits, _Alloc>* group, long arg) {
-			assert(group);
-			auto value = std::to_wstring(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<class _Traits = std::char_traits<wchar_t>, class _Alloc = std::allocator<wchar_t>>
-		inline auto ReadArgTo(StringArgGroup<wchar_t, _Traits, _Alloc>* group, float arg) {
-			assert(group);
-			auto value = std::to_wstring(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<class _Traits = std::char_traits<wchar_t>, class _Alloc = std::allocator<wchar_t>>
-		inline auto ReadArgTo(StringArgGroup<wchar_t, _Traits, _Alloc>* group, double arg) {
-			assert(group);
-			auto value = std::to_wstring(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-		inline auto ReadArgTo(StringArgGroup<_Elem, _Traits, _Alloc>* group, _Elem arg) {
-			assert(group);
-			auto value = std::basic_string<_Elem, _Traits, _Alloc>(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-		inline auto ReadArgTo(StringArgGroup<_Elem, _Traits, _Alloc>* group, const _Elem* arg) {
-			assert(group);
-			auto value = std::basic_string<_Elem, _Traits, _Alloc>(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-		template<typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-		inline auto ReadArgTo(StringArgGroup<_Elem, _Traits, _Alloc>* group, _Elem* arg) {
-			assert(group);
-			auto value = std::basic_string<_Elem, _Traits, _Alloc>(arg);
-			group->result.push_back(value);
-			group->totalCapacity += value.size();
-		}
-
-		template<typename Arg, typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-		inline auto ReadArg(StringArgGroup<_Elem, _Traits, _Alloc>* group, Arg arg) {
-			assert(group);
-			ReadArgTo(group, arg);
-		}
-		template<typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, typename Tuple, size_t _Index>
-		inline auto ReadArgInTuple(StringArgGroup<_Elem, _Traits, _Alloc>* group, const Tuple& tuple) {
-			assert(group);
-			static_assert(std::tuple_size<Tuple>::value > _Index, "Tuple must be the large than _INDEX.");
-			ReadArg(group, std::get<_Index>(tuple));
-		}
-		template<typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, typename Tuple, size_t ...Is>
-		inline auto ReadArgsAtIndex(StringArgGroup<_Elem, _Traits, _Alloc>* group, const Tuple& tuple, std::index_sequence<Is...>) {
-			assert(group);
-			auto seq = { ((ReadArgInTuple<_Elem, _Traits, _Alloc, Tuple, Is>(group, tuple)), 0)... };
-		}
-		template<typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, typename Tuple>
-		inline auto ReadArgsIndexsequence(StringArgGroup<_Elem, _Traits, _Alloc>* group, const Tuple& tuple) {
-			assert(group);
-			ReadArgsAtIndex<_Elem>(group, tuple, std::make_index_sequence<std::tuple_size<Tuple>::value>{});
-		}
-		template<typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, typename ...Args>
-		inline auto ArgsToTuple(StringArgGroup<_Elem, _Traits, _Alloc>* group, Args&&... args) {
-			assert(group);
-			std::tuple<Args&...> tuple{ std::forward<Args&>(args)... };
-			ReadArgsIndexsequence<_Elem>(group, tuple);
 		}
-		// -------------------------------------------------------------------
-		// Format.
-		// -------------------------------------------------------------------
-		template<typename _Elem>
-		struct StringFormatSegment {
-			_Elem* begin;
-			_Elem* end;
-			_Elem* next;
-			size_t index;
-			bool ok;
-		};
-		template<typename _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-		auto FormatString(const _Elem* format, _Elem* begin, size_t index) {
-			StringFormatSegment<_Elem> result{};
-			_Elem* pstr = (_Elem*)begin;
-			_Elem ch = *pstr;
-			result.begin = pstr;
-			// 1. find '{'.
-			while (ch && ch != '{') {
-				ch = *++pstr;
+		MultiReplacer(std::initializer_list<std::pair<std::string_view, std::string_view>> pairs, MatchOptions options = {})
+			: MultiReplacer(std::vector<std::pair<std::string_view, std::string_view>>(pairs), options) {}
+
+		size_t size() const {
+			return matcher.size();
+		}
+		// Appends text with every match replaced; returns the replacement count.
+		template <class _Traits, class _Alloc>
+		size_t ReplaceAll(std::string_view text, std::basic_string<char, _Traits, _Alloc>* presult) const {
+			assert(presult);
+			auto& lresult = *presult;
+			detail::Api_Probe probe(StringApi::MultiReplace, text.size());
+			const size_t capacity = lresult.capacity();
+			std::vector<MultiMatch> matches;
+			detail::FindLongestTo(matcher.automaton, text, &matches);
+			size_t size = text.size();
+			for (const auto& match : matches) {
+				size = size - match.length + replacements[match.pattern].size();
 			}
-			result.end = pstr;
-			if (!ch) {
-				return result;
+			const size_t base = lresult.size();
+			lresult.resize(base + size);
+			auto out = &lresult[base];
+			size_t pos{};
+			for (const auto& match : matches) {
+				auto replacement = replacements[match.pattern];
+				out = std::copy(text.data() + pos, text.data() + match.position, out);
+				out = std::copy(replacement.begin(), replacement.end(), out);
+				pos = match.position + match.length;
 			}
-			// 2. has index?
-			ch = *++pstr;
-			result.index = index;
-			if (ch && ch >= '0' && ch <= '9') {
-				int i = ch - '0';
-				result.index = static_cast<size_t>(i);
-				ch = *++pstr;
-			}
-			if (!ch) {
-				return result;
+			std::copy(text.data() + pos, text.data() + text.size(), out);
+			probe.Tokens(matches.size());
+			probe.Out(size);
+			probe.Grow(capacity, lresult.capacity(), sizeof(char));
+			return matches.size();
+		}
+		std::string ReplaceAll(std::string_view text) const {
+			std::string lresult{};
+			ReplaceAll(text, &lresult);
+			return lresult;
+		}
+		template <class _Traits, class _Alloc>
+		size_t ReplaceAll(std::basic_string<char, _Traits, _Alloc>* pstring) const {
+			assert(pstring);
+			std::basic_string<char, _Traits, _Alloc> lresult(pstring->get_allocator());
+			size_t count = ReplaceAll(std::string_view(pstring->data(), pstring->size()), &lresult);
+			if (count) {
+				pstring->swap(lresult);
 			}
-			// 3.. is '}'?
-			if (ch != '}') {
-				return result;
+			return count;
+		}
+	private:
+		template <class _Range>
+		static std::vector<std::string_view> Needles(const _Range& pairs) {
+			std::vector<std::string_view> needles;
+			for (const auto& pair : pairs) {
+				needles.emplace_back(std::get<0>(pair));
 			}
-			result.next = ++pstr;
-			result.ok = true;
-			return result;
+			return needles;
 		}
-	}
+
+		MultiMatcher matcher;
+		TokenArena<char> replacements;
+	};
 	// -------------------------------------------------------------------
-	// Trim.
+	// Lower/Upper
 	// -------------------------------------------------------------------
+	// ASCII letters are converted 16/32 bytes at a time; other characters go
+	// through the C locale functions, one byte (or wchar_t) at a time.
 	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void LTrim(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
+	auto ToLower(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
+		detail::Api_Probe probe(StringApi::Case, rstring.size());
+		auto cstring = rstring;
+		detail::CaseInPlace(&cstring, false, detail::To_Lower_Fn<_Elem>{});
+		probe.NewString(cstring);
+		return cstring;
+	}
+	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+	void ToLower(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
 		assert(pstring);
-		auto& lstring = *pstring;
-		auto not_space = lstring.find_first_not_of(detail::Space_v<_Elem>::value);
-		lstring.erase(0, not_space);
+		detail::Api_Probe probe(StringApi::Case, pstring->size());
+		detail::CaseInPlace(pstring, false, detail::To_Lower_Fn<_Elem>{});
+		probe.Out(pstring->size());
 	}
 	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto LTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
-		std::string cstring{};
-		auto not_space = rstring.find_first_not_of(detail::Space_v<_Elem>::value);
-		return cstring.assign(rstring, not_space);
+	auto ToUpper(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
+		detail::Api_Probe probe(StringApi::Case, rstring.size());
+		auto cstring = rstring;
+		detail::CaseInPlace(&cstring, true, detail::To_Upper_Fn<_Elem>{});
+		probe.NewString(cstring);
+		return cstring;
 	}
 	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void RTrim(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
+	void ToUpper(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
+		assert(pstring);
+		detail::Api_Probe probe(StringApi::Case, pstring->size());
+		detail::CaseInPlace(pstring, true, detail::To_Upper_Fn<_Elem>{});
+		probe.Out(pstring->size());
+	}
+	// UTF-8 aware variants: multibyte sequences are decoded and case mapped
+	// (Latin, Greek, Cyrillic, Armenian, Georgian, fullwidth); malformed bytes
+	// pass through. Independent of the locale.
+	template <class _Traits = std::char_traits<char>, class _Alloc = std::allocator<char>>
+	void ToLowerUtf8(std::basic_string<char, _Traits, _Alloc>* pstring) {
 		assert(pstring);
 		auto& lstring = *pstring;
-		auto not_space = lstring.find_last_not_of(detail::Space_v<_Elem>::value);
-		lstring.erase(not_space);
+		detail::Api_Probe probe(StringApi::Case, lstring.size());
+		lstring.resize(detail::CaseUtf8(lstring.data(), lstring.data(), lstring.size(), false));
+		probe.Out(lstring.size());
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto RTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
-		std::string cstring{};
-		auto not_space = rstring.find_last_not_of(detail::Space_v<_Elem>::value);
-		return cstring.assign(rstring, 0, not_space + 1);
+	template <class _Traits = std::char_traits<char>, class _Alloc = std::allocator<char>>
+	auto ToLowerUtf8(const std::basic_string<char, _Traits, _Alloc>& rstring) {
+		auto cstring = rstring;
+		ToLowerUtf8(&cstring);
+		return cstring;
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void Trim(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
+	template <class _Traits = std::char_traits<char>, class _Alloc = std::allocator<char>>
+	void ToUpperUtf8(std::basic_string<char, _Traits, _Alloc>* pstring) {
 		assert(pstring);
 		auto& lstring = *pstring;
-		auto left_space = lstring.find_first_not_of(detail::Space_v<_Elem>::value);
-		auto right_space = lstring.find_last_not_of(detail::Space_v<_Elem>::value);
-		lstring.assign(lstring, left_space, right_space);
+		detail::Api_Probe probe(StringApi::Case, lstring.size());
+		lstring.resize(detail::CaseUtf8(lstring.data(), lstring.data(), lstring.size(), true));
+		probe.Out(lstring.size());
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto Trim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
-		std::string cstring{};
-		auto left_space = rstring.find_first_not_of(detail::Space_v<_Elem>::value);
-		auto right_space = rstring.find_last_not_of(detail::Space_v<_Elem>::value);
-		cstring.assign(rstring, left_space, right_space);
+	template <class _Traits = std::char_traits<char>, class _Alloc = std::allocator<char>>
+	auto ToUpperUtf8(const std::basic_string<char, _Traits, _Alloc>& rstring) {
+		auto cstring = rstring;
+		ToUpperUtf8(&cstring);
 		return cstring;
 	}
 	// -------------------------------------------------------------------
-	// Split.
+	// StringBatch
 	// -------------------------------------------------------------------
+	// A column of strings in one character buffer plus size() + 1 offsets
+	// (Arrow layout: string i is [offsets[i], offsets[i + 1])). The batch
+	// kernels below make one linear pass over the buffer instead of one call
+	// per string.
 	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, std::vector< std::basic_string<_Elem, _Traits, _Alloc>>* presult) {
-		auto& lresult = *presult;
-		size_t begin{}, end{};
-		while (end != std::basic_string<_Elem, _Traits, _Alloc>::npos) {
-			end = rstring.find_first_of(delim, begin);
-			lresult.emplace_back(rstring, begin, end - begin);
-			begin = end + 1;
+	class StringBatch {
+		using _Offset_Alloc = typename std::allocator_traits<_Alloc>::template rebind_alloc<size_t>;
+	public:
+		using value_type = std::basic_string_view<_Elem, _Traits>;
+		using allocator_type = _Alloc;
+		using iterator = detail::Index_Iterator<StringBatch>;
+
+		StringBatch() : offsets_(1) {}
+		explicit StringBatch(const _Alloc& alloc) : chars_(alloc), offsets_(1, 0, _Offset_Alloc(alloc)) {}
+		template <class _Range>
+		static StringBatch FromVector(const _Range& strings, const _Alloc& alloc = _Alloc()) {
+			StringBatch lbatch(alloc);
+			size_t charCount{};
+			for (const auto& value : strings) {
+				charCount += value.size();
+			}
+			lbatch.reserve(charCount, static_cast<size_t>(std::distance(std::begin(strings), std::end(strings))));
+			for (const auto& value : strings) {
+				lbatch.push_back(value);
+			}
+			return lbatch;
 		}
-	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim, std::vector< std::basic_string<_Elem, _Traits, _Alloc>>* presult) {
-		auto& lresult = *presult;
-		size_t begin{}, end{}, not_lspace{}, not_rspace{};
-		while (end != std::basic_string<_Elem, _Traits, _Alloc>::npos) {
-			not_lspace = rstring.find_first_not_of(detail::Space_v<_Elem>::value, begin);
-			end = rstring.find_first_of(delim, begin);
-			not_rspace = rstring.find_last_not_of(detail::Space_v<_Elem>::value, end);
-			lresult.emplace_back(rstring, not_lspace, not_rspace - not_lspace);
-			begin = end + 1;
+		template <class _StrAlloc = std::allocator<_Elem>>
+		std::vector<std::basic_string<_Elem, _Traits, _StrAlloc>> ToVector() const {
+			std::vector<std::basic_string<_Elem, _Traits, _StrAlloc>> lresult;
+			lresult.reserve(size());
+			for (size_t i = 0; i < size(); ++i) {
+				lresult.emplace_back(chars_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+			}
+			return lresult;
+		}
+
+		size_t size() const {
+			return offsets_.size() - 1;
+		}
+		bool empty() const {
+			return offsets_.size() == 1;
+		}
+		value_type operator[](size_t index) const {
+			assert(index < size());
+			return value_type(chars_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+		}
+		iterator begin() const {
+			return iterator(this, 0);
+		}
+		iterator end() const {
+			return iterator(this, size());
+		}
+		// All characters, back to back.
+		value_type chars_view() const {
+			return value_type(chars_.data(), chars_.size());
+		}
+		const size_t* offsets() const {
+			return offsets_.data();
+		}
+		void clear() {
+			chars_.clear();
+			offsets_.resize(1);
+		}
+		void reserve(size_t charCount, size_t count) {
+			chars_.reserve(charCount);
+			offsets_.reserve(count + 1);
+		}
+		void push_back(value_type value) {
+			chars_.insert(chars_.end(), value.begin(), value.end());
+			offsets_.push_back(chars_.size());
+		}
+		// Raw access for the batch kernels; callers keep offsets consistent.
+		std::vector<_Elem, _Alloc>& chars_buffer() {
+			return chars_;
+		}
+		std::vector<size_t, _Offset_Alloc>& offsets_buffer() {
+			return offsets_;
+		}
+	private:
+		std::vector<_Elem, _Alloc> chars_;
+		std::vector<size_t, _Offset_Alloc> offsets_;
+	};
+	namespace detail {
+		// Splits every string of the batch with one sweep of the delimiter
+		// scanner over the whole buffer; a hit past the current string's end
+		// is kept for the strings after it.
+		template<class _Trim, class _Elem, class _Traits, class _Alloc, class _DelimFn, class _TokenAlloc, class _RowAlloc>
+		inline void SplitBatch(const StringBatch<_Elem, _Traits, _Alloc>& rbatch, const _DelimFn& fn, StringBatch<_Elem, _Traits, _TokenAlloc>* ptokens, std::vector<size_t, _RowAlloc>* prows) {
+			assert(ptokens && prows);
+			auto& ltokens = *ptokens;
+			auto& lrows = *prows;
+			const auto chars = rbatch.chars_view();
+			const auto offsets = rbatch.offsets();
+			Api_Probe probe(StringApi::Batch, chars.size());
+			const size_t count = ltokens.size();
+			const auto base = chars.data();
+			const auto last = base + chars.size();
+			ltokens.reserve(ltokens.chars_view().size() + chars.size(), ltokens.size() + rbatch.size() * 2);
+			if (lrows.empty()) {
+				lrows.push_back(ltokens.size());
+			}
+			lrows.reserve(lrows.size() + rbatch.size());
+			auto append = [&](auto token) {
+				ltokens.push_back(token);
+			};
+			auto delim = fn(base, last);
+			for (size_t i = 0; i < rbatch.size(); ++i) {
+				auto first = base + offsets[i];
+				const auto end = base + offsets[i + 1];
+				while (delim < end) {
+					EmitToken<_Trim, _Elem, _Traits>(first, delim, append);
+					first = delim + 1;
+					delim = fn(first, last);
+				}
+				EmitToken<_Trim, _Elem, _Traits>(first, end, append);
+				lrows.push_back(ltokens.size());
+			}
+			probe.Tokens(ltokens.size() - count);
 		}
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, std::vector< std::basic_string<_Elem, _Traits, _Alloc>>* presult) {
-		auto& lresult = *presult;
-		size_t begin{}, end{};
-		while (end != std::basic_string<_Elem, _Traits, _Alloc>::npos) {
-			end = rstring.find_first_of(delim, begin);
-			lresult.emplace_back(rstring, begin, end - begin);
-			begin = end + 1;
+	// Trims every string in place, compacting the buffer.
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void Trim(StringBatch<_Elem, _Traits, _Alloc>* pbatch) {
+		assert(pbatch);
+		auto& chars = pbatch->chars_buffer();
+		auto& offsets = pbatch->offsets_buffer();
+		detail::Api_Probe probe(StringApi::Batch, chars.size());
+		size_t first{}, write{};
+		for (size_t i = 1; i < offsets.size(); ++i) {
+			const size_t last = offsets[i];
+			auto token = detail::TrimToken<_Policy>(std::basic_string_view<_Elem, _Traits>(chars.data() + first, last - first));
+			_Traits::move(chars.data() + write, token.data(), token.size());
+			write += token.size();
+			offsets[i] = write;
+			first = last;
 		}
+		chars.resize(write);
+		probe.Out(write);
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim, std::vector< std::basic_string<_Elem, _Traits, _Alloc>>* presult) {
-		auto& lresult = *presult;
-		size_t begin{}, end{}, not_lspace{}, not_rspace{};
-		while (end != std::basic_string<_Elem, _Traits, _Alloc>::npos) {
-			not_lspace = rstring.find_first_not_of(detail::Space_v<_Elem>::value, begin);
-			end = rstring.find_first_of(delim, begin);
-			not_rspace = rstring.find_last_not_of(detail::Space_v<_Elem>::value, end);
-			lresult.emplace_back(rstring, not_lspace, not_rspace - not_lspace);
-			begin = end + 1;
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	auto Trim(const StringBatch<_Elem, _Traits, _Alloc>& rbatch) {
+		auto cbatch = rbatch;
+		Trim<_Policy>(&cbatch);
+		return cbatch;
+	}
+	// Case mapping keeps every length, so the offsets stay as they are and
+	// the whole buffer goes through the ASCII kernel in one call.
+	template <class _Elem, class _Traits, class _Alloc>
+	void ToLower(StringBatch<_Elem, _Traits, _Alloc>* pbatch) {
+		assert(pbatch);
+		auto& chars = pbatch->chars_buffer();
+		detail::Api_Probe probe(StringApi::Batch, chars.size());
+		if constexpr (detail::Is_Byte_Scan_v<_Elem, _Traits>) {
+			detail::CaseBytes(chars.data(), chars.data(), chars.size(), false, detail::To_Lower_Fn<_Elem>{});
+		}
+		else {
+			std::transform(chars.begin(), chars.end(), chars.begin(), detail::To_Lower_Fn<_Elem>{});
 		}
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim) {
-		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
-		size_t begin{}, end{};
-		while (end != std::basic_string<_Elem, _Traits, _Alloc>::npos) {
-			end = rstring.find_first_of(delim, begin);
-			lresult.emplace_back(rstring, begin, end - begin);
-			begin = end + 1;
+	template <class _Elem, class _Traits, class _Alloc>
+	auto ToLower(const StringBatch<_Elem, _Traits, _Alloc>& rbatch) {
+		auto cbatch = rbatch;
+		ToLower(&cbatch);
+		return cbatch;
+	}
+	template <class _Elem, class _Traits, class _Alloc>
+	void ToUpper(StringBatch<_Elem, _Traits, _Alloc>* pbatch) {
+		assert(pbatch);
+		auto& chars = pbatch->chars_buffer();
+		detail::Api_Probe probe(StringApi::Batch, chars.size());
+		if constexpr (detail::Is_Byte_Scan_v<_Elem, _Traits>) {
+			detail::CaseBytes(chars.data(), chars.data(), chars.size(), true, detail::To_Upper_Fn<_Elem>{});
+		}
+		else {
+			std::transform(chars.begin(), chars.end(), chars.begin(), detail::To_Upper_Fn<_Elem>{});
 		}
-		return lresult;
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, _Elem delim) {
-		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
-		size_t begin{}, end{}, not_lspace{}, not_rspace{};
-		while (end != std::basic_string<_Elem, _Traits, _Alloc>::npos) {
-			not_lspace = rstring.find_first_not_of(detail::Space_v<_Elem>::value, begin);
-			end = rstring.find_first_of(delim, begin);
-			not_rspace = rstring.find_last_not_of(detail::Space_v<_Elem>::value, end);
-			lresult.emplace_back(rstring, not_lspace, not_rspace - not_lspace);
-			begin = end + 1;
+	template <class _Elem, class _Traits, class _Alloc>
+	auto ToUpper(const StringBatch<_Elem, _Traits, _Alloc>& rbatch) {
+		auto cbatch = rbatch;
+		ToUpper(&cbatch);
+		return cbatch;
+	}
+	// Appends the tokens of every string to *ptokens; the tokens of string i
+	// are [rows[i], rows[i + 1]) in *ptokens (rows starts with a 0 entry).
+	template <class _Elem, class _Traits, class _Alloc, class _TokenAlloc, class _RowAlloc>
+	void Split(const StringBatch<_Elem, _Traits, _Alloc>& rbatch, _Elem delim, StringBatch<_Elem, _Traits, _TokenAlloc>* ptokens, std::vector<size_t, _RowAlloc>* prows) {
+		detail::SplitBatch<void>(rbatch, detail::Char_Delim_Fn<_Elem, _Traits>(delim), ptokens, prows);
+	}
+	template <class _Elem, class _Traits, class _Alloc, class _TokenAlloc, class _RowAlloc>
+	void Split(const StringBatch<_Elem, _Traits, _Alloc>& rbatch, const _Elem* delim, StringBatch<_Elem, _Traits, _TokenAlloc>* ptokens, std::vector<size_t, _RowAlloc>* prows) {
+		detail::SplitBatch<void>(rbatch, detail::Set_Delim_Fn<_Elem, _Traits>(delim), ptokens, prows);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _TokenAlloc, class _RowAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(const StringBatch<_Elem, _Traits, _Alloc>& rbatch, _Elem delim, StringBatch<_Elem, _Traits, _TokenAlloc>* ptokens, std::vector<size_t, _RowAlloc>* prows) {
+		detail::SplitBatch<_Policy>(rbatch, detail::Char_Delim_Fn<_Elem, _Traits>(delim), ptokens, prows);
+	}
+	template <class _Policy = SpaceOnly, class _Elem, class _Traits, class _Alloc, class _TokenAlloc, class _RowAlloc, detail::Enable_If_Policy_t<_Policy> = 0>
+	void SplitTrim(const StringBatch<_Elem, _Traits, _Alloc>& rbatch, const _Elem* delim, StringBatch<_Elem, _Traits, _TokenAlloc>* ptokens, std::vector<size_t, _RowAlloc>* prows) {
+		detail::SplitBatch<_Policy>(rbatch, detail::Set_Delim_Fn<_Elem, _Traits>(delim), ptokens, prows);
+	}
+	// Joins the whole column into one string.
+	template <class _Elem, class _Traits, class _Alloc, class _StrAlloc>
+	void Join(const StringBatch<_Elem, _Traits, _Alloc>& rbatch, std::basic_string_view<_Elem, _Traits> delim, std::basic_string<_Elem, _Traits, _StrAlloc>* presult) {
+		assert(presult);
+		auto& lresult = *presult;
+		if (rbatch.empty()) {
+			return;
 		}
+		const auto chars = rbatch.chars_view();
+		const auto offsets = rbatch.offsets();
+		detail::Api_Probe probe(StringApi::Batch, chars.size());
+		const size_t capacity = lresult.capacity();
+		size_t write = lresult.size();
+		lresult.resize(write + chars.size() + delim.size() * (rbatch.size() - 1));
+		probe.Out(lresult.size() - write);
+		probe.Grow(capacity, lresult.capacity(), sizeof(_Elem));
+		auto out = lresult.data() + write;
+		for (size_t i = 0; i < rbatch.size(); ++i) {
+			if (i) {
+				_Traits::copy(out, delim.data(), delim.size());
+				out += delim.size();
+			}
+			_Traits::copy(out, chars.data() + offsets[i], offsets[i + 1] - offsets[i]);
+			out += offsets[i + 1] - offsets[i];
+		}
+	}
+	template <class _Elem, class _Traits, class _Alloc>
+	auto Join(const StringBatch<_Elem, _Traits, _Alloc>& rbatch, _Elem delim) {
+		std::basic_string<_Elem, _Traits> lresult;
+		Join(rbatch, std::basic_string_view<_Elem, _Traits>(&delim, 1), &lresult);
 		return lresult;
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto Split(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim) {
-		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
-		size_t begin{}, end{};
-		while (end != std::basic_string<_Elem, _Traits, _Alloc>::npos) {
-			end = rstring.find_first_of(delim, begin);
-			lresult.emplace_back(rstring, begin, end - begin);
-			begin = end + 1;
-		}
+	template <class _Elem, class _Traits, class _Alloc>
+	auto Join(const StringBatch<_Elem, _Traits, _Alloc>& rbatch, const _Elem* delim) {
+		std::basic_string<_Elem, _Traits> lresult;
+		Join(rbatch, std::basic_string_view<_Elem, _Traits>(delim), &lresult);
 		return lresult;
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto SplitTrim(const std::basic_string<_Elem, _Traits, _Alloc>& rstring, const _Elem* delim) {
-		std::vector< std::basic_string<_Elem, _Traits, _Alloc>> lresult{};
-		size_t begin{}, end{}, not_lspace{}, not_rspace{};
-		while (end != std::basic_string<_Elem, _Traits, _Alloc>::npos) {
-			not_lspace = rstring.find_first_not_of(detail::Space_v<_Elem>::value, begin);
-			end = rstring.find_first_of(delim, begin);
-			not_rspace = rstring.find_last_not_of(detail::Space_v<_Elem>::value, end);
-			lresult.emplace_back(rstring, not_lspace, not_rspace - not_lspace);
-			begin = end + 1;
+	// Inverse of the batch Split: joins the tokens of each row into one
+	// string of *presult.
+	template <class _Elem, class _Traits, class _Alloc, class _RowAlloc, class _ResultAlloc>
+	void Join(const StringBatch<_Elem, _Traits, _Alloc>& rtokens, const std::vector<size_t, _RowAlloc>& rows, std::basic_string_view<_Elem, _Traits> delim, StringBatch<_Elem, _Traits, _ResultAlloc>* presult) {
+		assert(presult);
+		auto& lresult = *presult;
+		auto& chars = lresult.chars_buffer();
+		auto& offsets = lresult.offsets_buffer();
+		const auto tokenChars = rtokens.chars_view();
+		const auto tokenOffsets = rtokens.offsets();
+		detail::Api_Probe probe(StringApi::Batch, tokenChars.size());
+		const size_t count = rows.empty() ? 0 : rows.size() - 1;
+		offsets.reserve(offsets.size() + count);
+		size_t write = chars.size();
+		if (count) {
+			chars.resize(write + tokenOffsets[rows[count]] - tokenOffsets[rows[0]] + delim.size() * (rows[count] - rows[0]));
 		}
-		return lresult;
+		for (size_t i = 0; i < count; ++i) {
+			for (size_t token = rows[i]; token < rows[i + 1]; ++token) {
+				if (token != rows[i]) {
+					_Traits::copy(chars.data() + write, delim.data(), delim.size());
+					write += delim.size();
+				}
+				const size_t size = tokenOffsets[token + 1] - tokenOffsets[token];
+				_Traits::copy(chars.data() + write, tokenChars.data() + tokenOffsets[token], size);
+				write += size;
+			}
+			offsets.push_back(write);
+		}
+		chars.resize(write);
+		probe.Out(write);
 	}
 	// -------------------------------------------------------------------
-	// Lower/Upper
+	// MemoryWriter
 	// -------------------------------------------------------------------
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto ToLower(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
-		auto begin = rstring.begin();
-		const auto end = rstring.end();
-		std::basic_string<_Elem, _Traits, _Alloc> cstring{};
-		detail::To_Lower_Fn<_Elem> fn{};
+	// Growable buffer that keeps the first _InlineN elements on the stack and
+	// spills to the heap past that; clear() keeps the capacity for reuse.
+	template<class _Elem, size_t _InlineN = 256, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+	class MemoryWriter {
+		static_assert(_InlineN > 0, "MemoryWriter needs inline storage.");
+		using _Alloc_Traits = std::allocator_traits<_Alloc>;
+	public:
+		using value_type = _Elem;
+		using traits_type = _Traits;
+		using allocator_type = _Alloc;
 
-		cstring.reserve(rstring.size());
-		for (; begin != end; ++begin) {
-			cstring.push_back(fn(*begin));
+		MemoryWriter() = default;
+		explicit MemoryWriter(const _Alloc& alloc) : alloc(alloc) {}
+		MemoryWriter(const MemoryWriter&) = delete;
+		MemoryWriter& operator=(const MemoryWriter&) = delete;
+		~MemoryWriter() {
+			if (buffer != inlineBuffer) {
+				_Alloc_Traits::deallocate(alloc, buffer, bufferCapacity);
+			}
 		}
-		return cstring;
-	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void ToLower(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
-		auto& lstring = *pstring;
-		auto begin = lstring.begin();
-		const auto end = lstring.end();
-		detail::To_Lower_Fn<_Elem> fn{};
-		for (; begin != end; ++begin) {
-			*begin = fn(*begin);
+
+		const _Elem* data() const {
+			return buffer;
+		}
+		size_t size() const {
+			return length;
+		}
+		size_t capacity() const {
+			return bufferCapacity;
+		}
+		bool empty() const {
+			return length == 0;
+		}
+		bool inlined() const {
+			return buffer == inlineBuffer;
+		}
+		void clear() {
+			length = 0;
+		}
+		void reserve(size_t capacity) {
+			if (capacity <= bufferCapacity) {
+				return;
+			}
+			auto grown = _Alloc_Traits::allocate(alloc, capacity);
+			std::copy(buffer, buffer + length, grown);
+			if (buffer != inlineBuffer) {
+				_Alloc_Traits::deallocate(alloc, buffer, bufferCapacity);
+			}
+			buffer = grown;
+			bufferCapacity = capacity;
+		}
+		// Grows the size by count and returns the uninitialized tail.
+		_Elem* extend(size_t count) {
+			if (length + count > bufferCapacity) {
+				reserve(std::max(bufferCapacity * 2, length + count));
+			}
+			auto tail = buffer + length;
+			length += count;
+			return tail;
+		}
+		void append(const _Elem* str, size_t count) {
+			std::copy(str, str + count, extend(count));
+		}
+		void push_back(_Elem ch) {
+			*extend(1) = ch;
+		}
+		std::basic_string_view<_Elem, _Traits> view() const {
+			return { buffer, length };
+		}
+		std::basic_string<_Elem, _Traits, _Alloc> str() const {
+			return std::basic_string<_Elem, _Traits, _Alloc>(buffer, length, alloc);
+		}
+	private:
+		_Elem inlineBuffer[_InlineN];
+		_Elem* buffer{ inlineBuffer };
+		size_t length{};
+		size_t bufferCapacity{ _InlineN };
+		_Alloc alloc{};
+	};
+	namespace detail {
+		// -------------------------------------------------------------------
+		// Output Target.
+		// -------------------------------------------------------------------
+		// Strings and MemoryWriters are sized up front and written in place;
+		// anything else is treated as an output iterator over _Elem.
+		template<class _Target, class _Elem>
+		struct Output_Target {
+			static_assert(!std::is_void<_Elem>::value, "output iterators need an explicit element type.");
+			using elem_type = _Elem;
+			using traits_type = std::char_traits<_Elem>;
+			static constexpr bool sized = false;
+		};
+		template<class _Elem, class _Traits, class _Alloc, class _Hint>
+		struct Output_Target<std::basic_string<_Elem, _Traits, _Alloc>*, _Hint> {
+			static_assert(std::is_void<_Hint>::value || std::is_same<_Hint, _Elem>::value, "element type does not match the buffer.");
+			using elem_type = _Elem;
+			using traits_type = _Traits;
+			static constexpr bool sized = true;
+			// resize zero-fills the tail before it is overwritten. That one memset
+			// is accepted: it is cheaper than a size check on every append, and
+			// C++17 strings have no way to grow without initializing.
+			static _Elem* Extend(std::basic_string<_Elem, _Traits, _Alloc>* pbuffer, size_t count) {
+				auto size = pbuffer->size();
+				pbuffer->resize(size + count);
+				return pbuffer->data() + size;
+			}
+		};
+		template<class _Elem, size_t _InlineN, class _Traits, class _Alloc, class _Hint>
+		struct Output_Target<MemoryWriter<_Elem, _InlineN, _Traits, _Alloc>*, _Hint> {
+			static_assert(std::is_void<_Hint>::value || std::is_same<_Hint, _Elem>::value, "element type does not match the buffer.");
+			using elem_type = _Elem;
+			using traits_type = _Traits;
+			static constexpr bool sized = true;
+			static _Elem* Extend(MemoryWriter<_Elem, _InlineN, _Traits, _Alloc>* pwriter, size_t count) {
+				return pwriter->extend(count);
+			}
+		};
+		template<class _Target, class _Elem, class _SizeFn, class _WriteFn>
+		inline size_t EmitTo(StringApi api, _Target target, _SizeFn&& size, _WriteFn&& write) {
+			using _Output = Output_Target<_Target, _Elem>;
+			Api_Probe probe(api, 0);
+			if constexpr (_Output::sized) {
+				assert(target);
+				const size_t count = size();
+				const size_t capacity = target->capacity();
+				Pointer_Out<typename _Output::elem_type> out{ _Output::Extend(target, count) };
+				write(out);
+				probe.Out(count);
+				probe.Grow(capacity, target->capacity(), sizeof(typename _Output::elem_type));
+				return count;
+			}
+			else {
+				Iterator_Out<typename _Output::elem_type, _Target> out{ target, 0 };
+				write(out);
+				probe.Out(out.count);
+				return out.count;
+			}
+		}
+		// Runtime formats: a field whose index is past the last argument is
+		// copied to the output as written, e.g. "{3}" or "{:x}", so that the
+		// mistake shows in the result.
+		template<class _Elem, class _Traits, typename ...Args>
+		inline size_t FormatSize(std::basic_string_view<_Elem, _Traits> format, const Args&... args) {
+			size_t pos{}, index{}, total{};
+			while (true) {
+				auto segment = ParseFormatSegment(format, pos, index);
+				total += segment.literalEnd - pos;
+				if (!segment.field) {
+					return total;
+				}
+				if (segment.index < sizeof...(Args)) {
+					total += ArgSizeAt<_Elem, _Traits>(segment.index, segment.spec, args...);
+				}
+				else {
+					total += segment.next - segment.literalEnd;
+				}
+				index = segment.index + 1;
+				pos = segment.next;
+			}
+		}
+		template<class _Elem, class _Traits, class _Out, typename ...Args>
+		inline void WriteFormat(_Out& out, std::basic_string_view<_Elem, _Traits> format, const Args&... args) {
+			size_t pos{}, index{};
+			while (true) {
+				auto segment = ParseFormatSegment(format, pos, index);
+				out.Append(format.data() + pos, segment.literalEnd - pos);
+				if (!segment.field) {
+					return;
+				}
+				if (segment.index < sizeof...(Args)) {
+					WriteArgAt<_Elem, _Traits>(out, segment.index, segment.spec, args...);
+				}
+				else {
+					out.Append(format.data() + segment.literalEnd, segment.next - segment.literalEnd);
+				}
+				index = segment.index + 1;
+				pos = segment.next;
+			}
 		}
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	auto ToUpper(const std::basic_string<_Elem, _Traits, _Alloc>& rstring) {
-		auto begin = rstring.begin();
-		const auto end = rstring.end();
-		std::basic_string<_Elem, _Traits, _Alloc> cstring{};
-		detail::To_Upper_Fn<_Elem> fn{};
+	// -------------------------------------------------------------------
+	// FixedString
+	// -------------------------------------------------------------------
+	// Inline string of at most _Capacity elements; a literal type, so keys
+	// built from constants can be constexpr with static storage:
+	//   static constexpr auto key = cpp::Concat(cpp::FixedString("route:"), "v", 2);
+	// Exceeding the capacity throws std::length_error (a compile error in a
+	// constant expression).
+	template <class _Elem, size_t _Capacity>
+	class FixedString {
+	public:
+		using value_type = _Elem;
+		using traits_type = std::char_traits<_Elem>;
+		using size_type = size_t;
+		using const_iterator = const _Elem*;
+		using view_type = std::basic_string_view<_Elem>;
 
-		cstring.reserve(rstring.size());
-		for (; begin != end; ++begin) {
-			cstring.push_back(fn(*begin));
+		constexpr FixedString() = default;
+		template <size_t _Size>
+		constexpr FixedString(const _Elem(&literal)[_Size]) {
+			static_assert(_Size - 1 <= _Capacity, "literal longer than the capacity.");
+			append(literal, _Size - 1);
 		}
-		return cstring;
+		constexpr explicit FixedString(view_type value) {
+			append(value);
+		}
+
+		static constexpr size_t capacity() {
+			return _Capacity;
+		}
+		constexpr size_t size() const {
+			return count;
+		}
+		constexpr size_t length() const {
+			return count;
+		}
+		constexpr bool empty() const {
+			return count == 0;
+		}
+		constexpr const _Elem* data() const {
+			return chars;
+		}
+		constexpr const _Elem* c_str() const {
+			return chars;
+		}
+		constexpr const_iterator begin() const {
+			return chars;
+		}
+		constexpr const_iterator end() const {
+			return chars + count;
+		}
+		constexpr _Elem operator[](size_t index) const {
+			return chars[index];
+		}
+		constexpr view_type view() const {
+			return view_type(chars, count);
+		}
+		constexpr operator view_type() const {
+			return view();
+		}
+		template <class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
+		std::basic_string<_Elem, _Traits, _Alloc> str() const {
+			return std::basic_string<_Elem, _Traits, _Alloc>(chars, count);
+		}
+
+		constexpr void clear() {
+			count = 0;
+			chars[0] = _Elem();
+		}
+		constexpr FixedString& append(const _Elem* src, size_t size) {
+			if (size > _Capacity - count) {
+				throw std::length_error("FixedString: capacity exceeded");
+			}
+			// char_traits::copy is not constexpr before C++20.
+			for (size_t i = 0; i < size; ++i) {
+				chars[count + i] = src[i];
+			}
+			count += size;
+			chars[count] = _Elem();
+			return *this;
+		}
+		constexpr FixedString& append(view_type value) {
+			return append(value.data(), value.size());
+		}
+		constexpr FixedString& push_back(_Elem ch) {
+			return append(&ch, 1);
+		}
+		constexpr FixedString& operator+=(view_type value) {
+			return append(value);
+		}
+		// Element access for the constexpr kernels.
+		constexpr _Elem* buffer() {
+			return chars;
+		}
+		constexpr void assign_size(size_t size) {
+			count = size;
+			chars[count] = _Elem();
+		}
+	private:
+		_Elem chars[_Capacity + 1]{};
+		size_t count{};
+	};
+	template <class _Elem, size_t _Size>
+	FixedString(const _Elem(&)[_Size]) -> FixedString<_Elem, _Size - 1>;
+
+	template <class _Elem, size_t _Left, size_t _Right>
+	constexpr bool operator==(const FixedString<_Elem, _Left>& left, const FixedString<_Elem, _Right>& right) {
+		return left.view() == right.view();
 	}
-	template <class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>>
-	void ToUpper(std::basic_string<_Elem, _Traits, _Alloc>* pstring) {
-		auto& lstring = *pstring;
-		auto begin = lstring.begin();
-		const auto end = lstring.end();
-		detail::To_Upper_Fn<_Elem> fn{};
-		for (; begin != end; ++begin) {
-			*begin = fn(*begin);
+	template <class _Elem, size_t _Left, size_t _Right>
+	constexpr bool operator!=(const FixedString<_Elem, _Left>& left, const FixedString<_Elem, _Right>& right) {
+		return left.view() != right.view();
+	}
+	template <class _Elem, size_t _Left, size_t _Right>
+	constexpr bool operator<(const FixedString<_Elem, _Left>& left, const FixedString<_Elem, _Right>& right) {
+		return left.view() < right.view();
+	}
+	template <class _Elem, size_t _Capacity>
+	constexpr bool operator==(const FixedString<_Elem, _Capacity>& left, std::basic_string_view<_Elem> right) {
+		return left.view() == right;
+	}
+	template <class _Elem, size_t _Capacity>
+	constexpr bool operator==(std::basic_string_view<_Elem> left, const FixedString<_Elem, _Capacity>& right) {
+		return left == right.view();
+	}
+	template <class _Elem, size_t _Capacity>
+	constexpr bool operator!=(const FixedString<_Elem, _Capacity>& left, std::basic_string_view<_Elem> right) {
+		return left.view() != right;
+	}
+	template <class _Elem, size_t _Capacity>
+	constexpr bool operator!=(std::basic_string_view<_Elem> left, const FixedString<_Elem, _Capacity>& right) {
+		return left != right.view();
+	}
+	// A runtime string with a declared maximum width, so that Concat and
+	// Join can size their FixedString result: cpp::Bounded<32>(userName).
+	template <size_t _Max, class _Elem = char>
+	struct Bounded {
+		std::basic_string_view<_Elem> value;
+
+		constexpr Bounded(std::basic_string_view<_Elem> value) : value(value) {}
+	};
+	namespace detail {
+		// Width and element type of what a FixedString Concat/Join accepts:
+		// FixedString, literals, Bounded<N>, characters and integers.
+		template<class _Arg, class = void>
+		struct Fixed_Arg {
+			static constexpr bool value = false;
+			static constexpr bool text = false;
+			static constexpr bool sized = false;
+		};
+		template<class _Elem, size_t _Capacity>
+		struct Fixed_Arg<FixedString<_Elem, _Capacity>> {
+			static constexpr bool value = true;
+			static constexpr bool text = true;
+			static constexpr bool sized = true;
+			static constexpr size_t width = _Capacity;
+			using elem_type = _Elem;
+		};
+		template<class _Elem, size_t _Size>
+		struct Fixed_Arg<_Elem[_Size], std::enable_if_t<Is_Char_Type_v<_Elem>>> {
+			static constexpr bool value = true;
+			static constexpr bool text = true;
+			static constexpr bool sized = false;
+			static constexpr size_t width = _Size - 1;
+			using elem_type = _Elem;
+		};
+		template<size_t _Max, class _Elem>
+		struct Fixed_Arg<Bounded<_Max, _Elem>> {
+			static constexpr bool value = true;
+			static constexpr bool text = true;
+			static constexpr bool sized = true;
+			static constexpr size_t width = _Max;
+			using elem_type = _Elem;
+		};
+		template<class _Arg>
+		struct Fixed_Arg<_Arg, std::enable_if_t<Is_Char_Type_v<_Arg>>> {
+			static constexpr bool value = true;
+			static constexpr bool text = false;
+			static constexpr bool sized = false;
+			static constexpr size_t width = 1;
+		};
+		// digits10 + 1 digits, plus the sign.
+		template<class _Arg>
+		struct Fixed_Arg<_Arg, std::enable_if_t<std::is_integral<_Arg>::value && !Is_Char_Type_v<_Arg> && !std::is_same<_Arg, bool>::value>> {
+			static constexpr bool value = true;
+			static constexpr bool text = false;
+			static constexpr bool sized = false;
+			static constexpr size_t width = std::numeric_limits<_Arg>::digits10 + 1 + std::is_signed<_Arg>::value;
+		};
+		template<class... _Args>
+		constexpr bool Is_Fixed_Args_v = (Fixed_Arg<_Args>::value && ...) && (Fixed_Arg<_Args>::text || ...);
+		// A FixedString or Bounded argument switches Join to the FixedString form.
+		template<class... _Args>
+		constexpr bool Any_Fixed_Sized_v = (Fixed_Arg<std::remove_cv_t<std::remove_reference_t<_Args>>>::sized || ...);
+		template<class _Arg>
+		struct Fixed_Elem_Of {
+			using type = typename Fixed_Arg<_Arg>::elem_type;
+		};
+		// Element type of the first text argument.
+		template<class... _Args>
+		struct Fixed_Elem;
+		template<class _First, class... _Rest>
+		struct Fixed_Elem<_First, _Rest...> {
+			using type = typename std::conditional_t<Fixed_Arg<_First>::text, Fixed_Elem_Of<_First>, Fixed_Elem<_Rest...>>::type;
+		};
+		template<class... _Args>
+		using Fixed_Elem_t = typename Fixed_Elem<_Args...>::type;
+		template<class _Arg>
+		struct Is_Fixed_String : std::false_type {};
+		template<class _Elem, size_t _Capacity>
+		struct Is_Fixed_String<FixedString<_Elem, _Capacity>> : std::true_type {};
+
+		template<class _Elem, size_t _Capacity, class _Int>
+		constexpr void AppendInteger(FixedString<_Elem, _Capacity>* pout, _Int value) {
+			using _Unsigned = std::make_unsigned_t<_Int>;
+			bool negative{};
+			if constexpr (std::is_signed<_Int>::value) {
+				negative = value < 0;
+			}
+			_Unsigned magnitude = negative ? _Unsigned(0) - static_cast<_Unsigned>(value) : static_cast<_Unsigned>(value);
+			_Elem digits[std::numeric_limits<_Unsigned>::digits10 + 2]{};
+			size_t first = sizeof(digits) / sizeof(digits[0]);
+			do {
+				digits[--first] = static_cast<_Elem>('0' + magnitude % 10);
+				magnitude /= 10;
+			} while (magnitude);
+			if (negative) {
+				digits[--first] = static_cast<_Elem>('-');
+			}
+			pout->append(digits + first, sizeof(digits) / sizeof(digits[0]) - first);
+		}
+		template<class _Elem, size_t _Capacity, class _Arg>
+		constexpr void AppendFixed(FixedString<_Elem, _Capacity>* pout, const _Arg& arg) {
+			if constexpr (Is_Char_Type_v<_Arg>) {
+				pout->push_back(static_cast<_Elem>(arg));
+			}
+			else if constexpr (std::is_integral<_Arg>::value) {
+				AppendInteger(pout, arg);
+			}
+			else if constexpr (std::is_array<_Arg>::value) {
+				// a literal and a char buffer have the same type; both end at the
+				// first NUL, and the array size only bounds the capacity.
+				size_t size{};
+				while (size < Fixed_Arg<_Arg>::width && arg[size] != _Elem()) {
+					++size;
+				}
+				pout->append(arg, size);
+			}
+			else if constexpr (Is_Fixed_String<_Arg>::value) {
+				pout->append(arg.data(), arg.size());
+			}
+			else {
+				pout->append(arg.value.data(), arg.value.size());
+			}
+		}
+		template<class _Elem, size_t _Capacity, class _Fn>
+		constexpr FixedString<_Elem, _Capacity> MapFixed(const FixedString<_Elem, _Capacity>& rstring, _Fn fn) {
+			FixedString<_Elem, _Capacity> lresult = rstring;
+			auto data = lresult.buffer();
+			for (size_t i = 0; i < lresult.size(); ++i) {
+				data[i] = fn(data[i]);
+			}
+			return lresult;
+		}
+		template<class _Elem, size_t _Capacity>
+		constexpr FixedString<_Elem, _Capacity> SliceFixed(const FixedString<_Elem, _Capacity>& rstring, size_t first, size_t last) {
+			FixedString<_Elem, _Capacity> lresult;
+			lresult.append(rstring.data() + first, last - first);
+			return lresult;
 		}
 	}
+	// Concat into a FixedString sized from the arguments: array sizes less
+	// the NUL, FixedString and Bounded capacities, and the widest value of
+	// each integer type. Runs at compile time when every argument is constant,
+	// otherwise fills a stack buffer.
+	template <class... _Args, std::enable_if_t<detail::Is_Fixed_Args_v<_Args...>, int> = 0>
+	constexpr auto Concat(const _Args&... args) {
+		FixedString<detail::Fixed_Elem_t<_Args...>, (detail::Fixed_Arg<_Args>::width + ... + 0)> lresult;
+		(detail::AppendFixed(&lresult, args), ...);
+		return lresult;
+	}
+	// Join into a FixedString; chosen when an argument is a FixedString or a
+	// Bounded, plain literals keep going through the std::basic_string Join.
+	template <class _Delim, class... _Args, std::enable_if_t<detail::Is_Fixed_Args_v<_Delim, _Args...> && detail::Any_Fixed_Sized_v<_Delim, _Args...>, int> = 0>
+	constexpr auto Join(const _Delim& delim, const _Args&... args) {
+		constexpr size_t count = sizeof...(_Args);
+		FixedString<detail::Fixed_Elem_t<_Delim, _Args...>, (detail::Fixed_Arg<_Args>::width + ... + 0) + detail::Fixed_Arg<_Delim>::width * (count ? count - 1 : 0)> lresult;
+		size_t index{};
+		((index++ ? detail::AppendFixed(&lresult, delim) : void(), detail::AppendFixed(&lresult, args)), ...);
+		return lresult;
+	}
+	// ASCII case mapping, usable in constant expressions; other elements are
+	// kept as they are.
+	template <class _Elem, size_t _Capacity>
+	constexpr FixedString<_Elem, _Capacity> ToLower(const FixedString<_Elem, _Capacity>& rstring) {
+		return detail::MapFixed(rstring, [](_Elem ch) { return ch >= 'A' && ch <= 'Z' ? static_cast<_Elem>(ch + ('a' - 'A')) : ch; });
+	}
+	template <class _Elem, size_t _Capacity>
+	constexpr FixedString<_Elem, _Capacity> ToUpper(const FixedString<_Elem, _Capacity>& rstring) {
+		return detail::MapFixed(rstring, [](_Elem ch) { return ch >= 'a' && ch <= 'z' ? static_cast<_Elem>(ch - ('a' - 'A')) : ch; });
+	}
+	template <class _Policy = SpaceOnly, class _Elem, size_t _Capacity, detail::Enable_If_Policy_t<_Policy> = 0>
+	constexpr FixedString<_Elem, _Capacity> LTrim(const FixedString<_Elem, _Capacity>& rstring) {
+		return detail::SliceFixed(rstring, detail::SpacePrefix<_Policy>(rstring.data(), rstring.size()), rstring.size());
+	}
+	template <class _Policy = SpaceOnly, class _Elem, size_t _Capacity, detail::Enable_If_Policy_t<_Policy> = 0>
+	constexpr FixedString<_Elem, _Capacity> RTrim(const FixedString<_Elem, _Capacity>& rstring) {
+		return detail::SliceFixed(rstring, 0, detail::SpaceEnd<_Policy>(rstring.data(), rstring.size()));
+	}
+	template <class _Policy = SpaceOnly, class _Elem, size_t _Capacity, detail::Enable_If_Policy_t<_Policy> = 0>
+	constexpr FixedString<_Elem, _Capacity> Trim(const FixedString<_Elem, _Capacity>& rstring) {
+		const size_t last = detail::SpaceEnd<_Policy>(rstring.data(), rstring.size());
+		return detail::SliceFixed(rstring, detail::SpacePrefix<_Policy>(rstring.data(), last), last);
+	}
+	namespace detail {
+		template<typename _Elem, class _Traits, size_t _Capacity>
+		struct Arg_Writer<_Elem, _Traits, FixedString<_Elem, _Capacity>, std::enable_if_t<std::is_same<_Traits, std::char_traits<_Elem>>::value>> : Text_Arg_Writer<_Elem, _Traits> {};
+		template<typename _Elem, class _Traits, size_t _Max>
+		struct Arg_Writer<_Elem, _Traits, Bounded<_Max, _Elem>, std::enable_if_t<std::is_same<_Traits, std::char_traits<_Elem>>::value>> {
+			static size_t Size(const Bounded<_Max, _Elem>& arg, const Format_Spec& spec) {
+				return Text_Arg_Writer<_Elem, _Traits>::Size(arg.value, spec);
+			}
+			template<class _Out>
+			static void Write(_Out& out, const Bounded<_Max, _Elem>& arg, const Format_Spec& spec) {
+				Text_Arg_Writer<_Elem, _Traits>::Write(out, arg.value, spec);
+			}
+		};
+	}
 	// -------------------------------------------------------------------
 	// Concat
 	// -------------------------------------------------------------------
+	// The *To variants append to a basic_string*, a MemoryWriter* or an output
+	// iterator and return the number of elements written.
+	template<class _Elem = void, class _Target, typename ...Args>
+	size_t ConcatTo(_Target target, Args&&... args) {
+		using _Output = detail::Output_Target<_Target, _Elem>;
+		using _Char = typename _Output::elem_type;
+		using _Traits = typename _Output::traits_type;
+		return detail::EmitTo<_Target, _Char>(StringApi::Concat, target,
+			[&] { return detail::ArgsSize<_Char, _Traits>(args...); },
+			[&](auto& out) { detail::WriteArgs<_Char, _Traits>(out, args...); });
+	}
 	template<class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, typename ...Args>
 	auto Concat(Args&&... args) {
-		detail::StringArgGroup<_Elem, _Traits, _Alloc> group{};
 		std::basic_string<_Elem, _Traits, _Alloc> value{};
-
-		detail::ArgsToTuple(&group, std::forward<Args&>(args)...);
-		value.reserve(group.totalCapacity);
-		for (auto& s : group.result) {
-			value.append(s);
-		}
+		ConcatTo(&value, args...);
 		return value;
 	}
 	// -----------------------------------------------------------------------
 	// Join
 	// -----------------------------------------------------------------------
+	template<class _Target, class _Elem, typename ...Args>
+	size_t JoinTo(_Target target, const _Elem* delim, Args&&... args) {
+		using _Traits = typename detail::Output_Target<_Target, _Elem>::traits_type;
+		constexpr size_t count = sizeof...(Args);
+		const size_t delimSize = _Traits::length(delim);
+		return detail::EmitTo<_Target, _Elem>(StringApi::Join, target,
+			[&] { return detail::ArgsSize<_Elem, _Traits>(args...) + delimSize * (count ? count - 1 : 0); },
+			[&](auto& out) { detail::WriteJoined<_Elem, _Traits>(out, delim, delimSize, args...); });
+	}
+	template<class _Target, class _Elem, typename ...Args>
+	size_t JoinTo(_Target target, _Elem delim, Args&&... args) {
+		using _Traits = typename detail::Output_Target<_Target, _Elem>::traits_type;
+		constexpr size_t count = sizeof...(Args);
+		return detail::EmitTo<_Target, _Elem>(StringApi::Join, target,
+			[&] { return detail::ArgsSize<_Elem, _Traits>(args...) + (count ? count - 1 : 0); },
+			[&](auto& out) { detail::WriteJoined<_Elem, _Traits>(out, &delim, 1, args...); });
+	}
 	template<class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, typename ...Args>
-	auto Join(_Elem delim, Args&&... args) {
-		detail::StringArgGroup<_Elem, _Traits, _Alloc> group{};
+	auto Join(_Elem delim, Args&&... args) -> std::enable_if_t<detail::Is_Char_Type_v<_Elem> && !detail::Any_Fixed_Sized_v<Args...>, std::basic_string<_Elem, _Traits, _Alloc>> {
 		std::basic_string<_Elem, _Traits, _Alloc> value{};
-		detail::ArgsToTuple(&group, std::forward<Args&>(args)...);
-		auto result = group.result;
-		auto size = result.size();
-		if (size < 2) {
-			if (size == 1) {
-				return result[0];
-			}
-			return value;
-		}
-		value.reserve(group.totalCapacity + size);
-		value += result[0];
-		for (size_t i = 1; i < size; ++i) {
-			value += delim;
-			value += result[i];
-		}
+		JoinTo(&value, delim, args...);
 		return value;
 	}
 	template<class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, size_t _Size, typename ...Args>
 	auto Join(const _Elem(*delim)[_Size], Args&&... args) {
-		detail::StringArgGroup<_Elem, _Traits, _Alloc> group{};
 		std::basic_string<_Elem, _Traits, _Alloc> value{};
-		detail::ArgsToTuple(&group, std::forward<Args&>(args)...);
-		auto result = group.result;
-		auto size = result.size();
-		if (size < 2) {
-			if (size == 1) {
-				return result[0];
-			}
-			return value;
-		}
-		value.reserve(group.totalCapacity + _Size * size);
-		value += result[0];
-		for (size_t i = 1; i < size; ++i) {
-			value += delim;
-			value += result[i];
-		}
+		JoinTo(&value, static_cast<const _Elem*>(*delim), args...);
 		return value;
 	}
 	// -----------------------------------------------------------------------
 	// Format
 	// -----------------------------------------------------------------------
+	template<class _Target, class _Elem, typename ...Args>
+	size_t FormatTo(_Target target, const _Elem* format, Args&&... args) {
+		using _Traits = typename detail::Output_Target<_Target, _Elem>::traits_type;
+		std::basic_string_view<_Elem, _Traits> view(format);
+		return detail::EmitTo<_Target, _Elem>(StringApi::Format, target,
+			[&] { return detail::FormatSize(view, args...); },
+			[&](auto& out) { detail::WriteFormat(out, view, args...); });
+	}
+	template<class _Target, class _Elem, class _Traits, class _Alloc, typename ...Args>
+	size_t FormatTo(_Target target, const std::basic_string<_Elem, _Traits, _Alloc>& format, Args&&... args) {
+		return FormatTo(target, format.c_str(), args...);
+	}
+	// Format string parsed at compile time, see CPP_FMT.
+	template<class _Target, class _FormatString, typename ...Args, std::enable_if_t<std::is_base_of<detail::Format_String_Tag, _FormatString>::value, int> = 0>
+	size_t FormatTo(_Target target, _FormatString, Args&&... args) {
+		constexpr auto format = _FormatString::value();
+		constexpr auto scan = detail::ScanFormat(format);
+		static_assert(scan.ok, "malformed format field, expected '{}', '{N}' or '{N:spec}'.");
+		static_assert(scan.arity <= sizeof...(Args), "format references more arguments than were passed.");
+		using _Elem = typename decltype(format)::value_type;
+		using _Traits = typename decltype(format)::traits_type;
+
+		using _Fields = std::make_index_sequence<scan.fields>;
+
+		auto tuple = std::forward_as_tuple(args...);
+		return detail::EmitTo<_Target, _Elem>(StringApi::Format, target,
+			[&] { return detail::PlannedFormatSize<_FormatString, _Elem, _Traits>(tuple, _Fields{}); },
+			[&](auto& out) { detail::WritePlannedFormat<_FormatString, _Elem, _Traits>(out, tuple, _Fields{}); });
+	}
 	template<class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, typename ...Args>
 	auto Format(const _Elem* format, Args&&... args) {
-		detail::StringArgGroup<_Elem, _Traits, _Alloc> group{};
 		std::basic_string<_Elem, _Traits, _Alloc> result{};
-		_Elem* pstr = (_Elem*)format;
-		size_t index{};
-		detail::ArgsToTuple(&group, std::forward<Args&>(args)...);
-		while (pstr) {
-			auto segment = detail::FormatString(format, pstr, index);
-			pstr = (_Elem*)segment.begin;
-			_Elem _end = *segment.end;
-			for (; *pstr != _end; ++pstr) {
-				result.push_back(*pstr);
-			}
-			if (!segment.ok) {
-				break;
-			}
-			result.append(group.result[index]);
-			index = segment.index + 1;
-			pstr = segment.next;
-		}
+		FormatTo(&result, format, args...);
 		return result;
 	}
 	template<class _Elem, class _Traits = std::char_traits<_Elem>, class _Alloc = std::allocator<_Elem>, typename ...Args>
 	auto Format(const std::basic_string<_Elem, _Traits, _Alloc>& format, Args&&... args) {
-		return Format(format.c_str(), std::forward<Args&>(args)...);
+		std::basic_string<_Elem, _Traits, _Alloc> result{};
+		FormatTo(&result, format.c_str(), args...);
+		return result;
+	}
+	template<class _FormatString, typename ...Args, std::enable_if_t<std::is_base_of<detail::Format_String_Tag, _FormatString>::value, int> = 0>
+	auto Format(_FormatString format, Args&&... args) {
+		using _View = decltype(_FormatString::value());
+		std::basic_string<typename _View::value_type, typename _View::traits_type> result{};
+		FormatTo(&result, format, args...);
+		return result;
+	}
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+	template<detail::Format_Literal _Format, typename ...Args>
+	auto Format(Args&&... args) {
+		return Format(detail::Format_Literal_String<_Format>{}, std::forward<Args>(args)...);
 	}
+#endif
+}
 
-}
\ No newline at end of file
+// Wraps a string literal so Format can parse it at compile time:
+//   cpp::Format(CPP_FMT("user={} id={1}"), name, id);
+#define CPP_FMT(literal) \
+	([] { \
+		struct _Cpp_Format_String : ::cpp::detail::Format_String_Tag { \
+			static constexpr auto value() { return std::basic_string_view(literal); } \
+		}; \
+		return _Cpp_Format_String{}; \
+	}())
@@ -0,0 +1,102 @@
+// StringBatch: layout, and the batch Trim, case, Split and Join kernels
+// against the same calls made one string at a time.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+namespace {
+	using Batch = cpp::StringBatch<char>;
+
+	std::vector<std::string> RandomStrings(size_t count, const std::string& alphabet) {
+		std::vector<std::string> strings(count);
+		for (auto& value : strings) {
+			value.resize(test::Below(12));
+			for (auto& ch : value) {
+				ch = alphabet[test::Below(alphabet.size())];
+			}
+		}
+		return strings;
+	}
+
+	void TestLayout() {
+		const std::vector<std::string> strings{ "ab", "", "cde" };
+		auto batch = Batch::FromVector(strings);
+		CHECK_EQ(batch.size(), size_t{ 3 });
+		CHECK(!batch.empty());
+		CHECK_EQ(batch[1], std::string_view());
+		CHECK_EQ(batch[2], std::string_view("cde"));
+		CHECK_EQ(batch.chars_view(), std::string_view("abcde"));
+		CHECK(batch.offsets()[0] == 0 && batch.offsets()[1] == 2 && batch.offsets()[2] == 2 && batch.offsets()[3] == 5);
+		CHECK_EQ(batch.ToVector(), strings);
+		std::vector<std::string_view> iterated(batch.begin(), batch.end());
+		CHECK_EQ(iterated.size(), size_t{ 3 });
+		batch.push_back("f");
+		CHECK_EQ(batch.size(), size_t{ 4 });
+		batch.clear();
+		CHECK(batch.empty() && batch.chars_view().empty());
+	}
+	void TestTrimAndCase() {
+		auto batch = Batch::FromVector(std::vector<std::string>{ " a ", "", "\tb\t", "  ", "c" });
+		cpp::Trim<cpp::AsciiSpace>(&batch);
+		CHECK_EQ(batch.ToVector(), (std::vector<std::string>{ "a", "", "b", "", "c" }));
+		CHECK_EQ(batch.chars_view(), std::string_view("abc"));
+
+		for (int round = 0; round < 50; ++round) {
+			const auto strings = RandomStrings(40, " aBz\tQ\xC3\x80");
+			const auto source = Batch::FromVector(strings);
+			auto trimmed = cpp::Trim(source).ToVector();
+			auto lower = cpp::ToLower(source).ToVector();
+			auto upper = cpp::ToUpper(source).ToVector();
+			for (size_t i = 0; i < strings.size(); ++i) {
+				CHECK_EQ(trimmed[i], cpp::Trim(strings[i]));
+				CHECK_EQ(lower[i], cpp::ToLower(strings[i]));
+				CHECK_EQ(upper[i], cpp::ToUpper(strings[i]));
+			}
+		}
+	}
+	void TestSplitJoin() {
+		auto batch = Batch::FromVector(std::vector<std::string>{ "a,b", "", "c,,d" });
+		Batch tokens;
+		std::vector<size_t> rows;
+		cpp::Split(batch, ',', &tokens, &rows);
+		CHECK_EQ(tokens.ToVector(), (std::vector<std::string>{ "a", "b", "", "c", "", "d" }));
+		CHECK_EQ(rows, (std::vector<size_t>{ 0, 2, 3, 6 }));
+		CHECK_EQ(cpp::Join(batch, '|'), std::string("a,b||c,,d"));
+		CHECK_EQ(cpp::Join(batch, "; "), std::string("a,b; ; c,,d"));
+		CHECK_EQ(cpp::Join(Batch(), ','), std::string());
+		Batch joined;
+		cpp::Join(tokens, rows, std::string_view(","), &joined);
+		CHECK_EQ(joined.ToVector(), batch.ToVector());
+
+		for (int round = 0; round < 50; ++round) {
+			const auto strings = RandomStrings(30, "ab ,;");
+			const auto source = Batch::FromVector(strings);
+			Batch split, splitSet, splitTrim;
+			std::vector<size_t> splitRows, setRows, trimRows;
+			cpp::Split(source, ',', &split, &splitRows);
+			cpp::Split(source, ",;", &splitSet, &setRows);
+			cpp::SplitTrim(source, ',', &splitTrim, &trimRows);
+			for (size_t i = 0; i < strings.size(); ++i) {
+				auto slice = [](const Batch& all, const std::vector<size_t>& bounds, size_t row) {
+					std::vector<std::string> values;
+					for (size_t token = bounds[row]; token < bounds[row + 1]; ++token) {
+						values.emplace_back(all[token]);
+					}
+					return values;
+				};
+				CHECK_EQ(slice(split, splitRows, i), cpp::Split(strings[i], ','));
+				CHECK_EQ(slice(splitSet, setRows, i), cpp::Split(strings[i], ",;"));
+				CHECK_EQ(slice(splitTrim, trimRows, i), cpp::SplitTrim(strings[i], ','));
+			}
+			Batch rejoined;
+			cpp::Join(split, splitRows, std::string_view(","), &rejoined);
+			CHECK_EQ(rejoined.ToVector(), strings);
+		}
+	}
+}
+
+int main() {
+	TestLayout();
+	TestTrimAndCase();
+	TestSplitJoin();
+	return test::Report("batch_test");
+}
@@ -0,0 +1,114 @@
+// ToLower/ToUpper: the scalar, SSE2 and AVX2 ASCII kernels against each
+// other, and the UTF-8 case tables against fixed text and, where the C.UTF-8
+// locale exists, against towlower/towupper.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+#include <clocale>
+#include <cwctype>
+
+namespace {
+	using Kernel = size_t(*)(const char*, char*, size_t, bool);
+
+	std::vector<Kernel> Kernels() {
+		std::vector<Kernel> kernels{ cpp::detail::CaseAsciiScalar };
+#if defined(STRING_UTIL_X86)
+		if (cpp::detail::CurrentSimdLevel() != cpp::detail::SimdLevel::Scalar) {
+			kernels.push_back(cpp::detail::CaseAsciiSse2);
+		}
+		if (cpp::detail::CurrentSimdLevel() == cpp::detail::SimdLevel::Avx2) {
+			kernels.push_back(cpp::detail::CaseAsciiAvx2);
+		}
+#endif
+		return kernels;
+	}
+	std::string Utf8(uint32_t cp) {
+		char bytes[4];
+		return std::string(bytes, cpp::detail::EncodeUtf8(cp, bytes));
+	}
+
+	void TestAsciiKernels() {
+		const std::string alphabet("aZz@[`{AQm09 \x7f\x80\xc3", 17);
+		for (size_t size = 0; size < 200; ++size) {
+			std::string text(size, ' ');
+			for (auto& ch : text) {
+				// mostly ASCII, so that the kernels run for whole blocks.
+				ch = alphabet[test::Below(size % 3 ? 15 : alphabet.size())];
+			}
+			for (bool upper : { false, true }) {
+				size_t ascii = 0;
+				std::string expected = text;
+				while (ascii < text.size() && static_cast<unsigned char>(text[ascii]) < 0x80) {
+					const char ch = text[ascii];
+					expected[ascii++] = upper ? (ch >= 'a' && ch <= 'z' ? ch - 32 : ch) : (ch >= 'A' && ch <= 'Z' ? ch + 32 : ch);
+				}
+				for (auto kernel : Kernels()) {
+					std::string converted = text;
+					CHECK_EQ(kernel(text.data(), &converted[0], text.size(), upper), ascii);
+					CHECK_EQ(converted, expected);
+				}
+			}
+		}
+	}
+	void TestStrings() {
+		const std::string text = "Hello, World! 0123456789 [@`{] THE QUICK BROWN FOX jumps";
+		CHECK_EQ(cpp::ToLower(text), std::string("hello, world! 0123456789 [@`{] the quick brown fox jumps"));
+		CHECK_EQ(cpp::ToUpper(text), std::string("HELLO, WORLD! 0123456789 [@`{] THE QUICK BROWN FOX JUMPS"));
+		std::string inplace = "MiXeD \xC3\x80 Case";
+		cpp::ToLower(&inplace);
+		// in the C locale bytes >= 0x80 stay as they are.
+		CHECK_EQ(inplace, std::string("mixed \xC3\x80 case"));
+		cpp::ToUpper(&inplace);
+		CHECK_EQ(inplace, std::string("MIXED \xC3\x80 CASE"));
+		CHECK(cpp::ToUpper(std::wstring(L"wide Text")) == L"WIDE TEXT");
+		CHECK_EQ(cpp::ToLower(std::string()), std::string());
+	}
+	void TestUtf8() {
+		// Latin-1, Latin Extended-A, Greek, Cyrillic, Armenian, Georgian, fullwidth.
+		CHECK_EQ(cpp::ToLowerUtf8(std::string("\xC3\x80\xC3\x89\xC3\x9C \xC3\x97 \xC4\x80\xC4\x82 \xC5\xB8")),
+			std::string("\xC3\xA0\xC3\xA9\xC3\xBC \xC3\x97 \xC4\x81\xC4\x83 \xC3\xBF"));
+		CHECK_EQ(cpp::ToLowerUtf8(std::string("\xCE\x91\xCE\xA3\xCE\x86 \xD0\x9F\xD0\x81 \xD4\xB1")),
+			std::string("\xCE\xB1\xCF\x83\xCE\xAC \xD0\xBF\xD1\x91 \xD5\xA1"));
+		CHECK_EQ(cpp::ToLowerUtf8(std::string("\xE1\x82\xA0\xEF\xBC\xA1")), std::string("\xE2\xB4\x80\xEF\xBD\x81"));
+		CHECK_EQ(cpp::ToUpperUtf8(std::string("stra\xC3\x9F" "e \xC3\xBF \xCF\x82 \xE2\x93\x90")),
+			std::string("STRA\xC3\x9F" "E \xC5\xB8 \xCE\xA3 \xE2\x92\xB6"));
+		// mappings that shorten the text: U+0130, U+0131, U+017F.
+		CHECK_EQ(cpp::ToLowerUtf8(std::string("\xC4\xB0stanbul")), std::string("istanbul"));
+		CHECK_EQ(cpp::ToUpperUtf8(std::string("\xC4\xB1\xC5\xBF!")), std::string("IS!"));
+		// malformed and unmapped sequences pass through; ASCII around them is converted.
+		CHECK_EQ(cpp::ToUpperUtf8(std::string("\xFF" "a\xC0\xAF" "b\xE2\x82")), std::string("\xFF" "A\xC0\xAF" "B\xE2\x82"));
+		CHECK_EQ(cpp::ToUpperUtf8(std::string("\xF0\x9F\x98\x80x")), std::string("\xF0\x9F\x98\x80X"));
+		// a long ASCII run before the multibyte part.
+		const std::string ascii(100, 'Q');
+		CHECK_EQ(cpp::ToLowerUtf8(ascii + "\xD0\x9F"), std::string(100, 'q') + "\xD0\xBF");
+		std::string inplace = "\xCE\x91" "BC";
+		cpp::ToLowerUtf8(&inplace);
+		CHECK_EQ(inplace, std::string("\xCE\xB1" "bc"));
+	}
+	// Every code point of the covered blocks against the C library.
+	void TestUtf8Locale() {
+		if (!std::setlocale(LC_CTYPE, "C.UTF-8")) {
+			std::printf("case_test: no C.UTF-8 locale, skipping the towlower comparison\n");
+			return;
+		}
+		const std::pair<uint32_t, uint32_t> blocks[] = {
+			{ 0x0, 0x17F }, { 0x386, 0x3CE }, { 0x400, 0x52F }, { 0x531, 0x586 }, { 0x10A0, 0x10C5 },
+			{ 0x1E00, 0x1E9A }, { 0x1EA0, 0x1EFF }, { 0x2160, 0x217F }, { 0x24B6, 0x24E9 }, { 0xFF21, 0xFF5A },
+		};
+		for (auto [first, last] : blocks) {
+			for (uint32_t cp = first; cp <= last; ++cp) {
+				CHECK_EQ(cpp::ToLowerUtf8(Utf8(cp)), Utf8(static_cast<uint32_t>(std::towlower(static_cast<wint_t>(cp)))));
+				CHECK_EQ(cpp::ToUpperUtf8(Utf8(cp)), Utf8(static_cast<uint32_t>(std::towupper(static_cast<wint_t>(cp)))));
+			}
+		}
+		std::setlocale(LC_CTYPE, "C");
+	}
+}
+
+int main() {
+	TestAsciiKernels();
+	TestStrings();
+	TestUtf8();
+	TestUtf8Locale();
+	return test::Report("case_test");
+}
@@ -0,0 +1,122 @@
+// CsvView on quoted fields, CRLF endings and records that straddle the
+// 64-byte blocks of the indexer; the scalar and SIMD indexers must agree.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+namespace {
+	using Rows = std::vector<std::vector<std::string>>;
+
+	Rows Parse(std::string_view text, cpp::CsvDialect dialect = {}) {
+		Rows rows;
+		for (auto& row : cpp::CsvView(text, dialect)) {
+			rows.emplace_back();
+			for (auto field : row) {
+				rows.back().push_back(field.str());
+			}
+		}
+		return rows;
+	}
+	std::string Quote(const std::string& field) {
+		std::string quoted = "\"";
+		for (char ch : field) {
+			quoted += ch;
+			if (ch == '"') {
+				quoted += '"';
+			}
+		}
+		return quoted + "\"";
+	}
+
+	void TestQuotes() {
+		auto rows = Parse("a,\"b,c\",\"d\"\"e\"\n\"multi\nline\",\"\"\n");
+		CHECK_EQ(rows.size(), size_t{ 2 });
+		CHECK_EQ(rows[0], (std::vector<std::string>{ "a", "b,c", "d\"e" }));
+		CHECK_EQ(rows[1], (std::vector<std::string>{ "multi\nline", "" }));
+
+		cpp::BasicCsvView<> view("x,\"y\"\"\",z");
+		auto row = *view.begin();
+		CHECK(!row[0].quoted());
+		CHECK(row[1].quoted());
+		CHECK(row[1].escaped());
+		CHECK_EQ(row[1].raw(), std::string_view("\"y\"\"\""));
+		std::string scratch;
+		CHECK_EQ(row[1].value(&scratch), std::string_view("y\""));
+		CHECK(view.ok());
+		CHECK(!cpp::CsvView("a,\"open\n").ok());
+	}
+	void TestLineEndings() {
+		CHECK_EQ(Parse("a,b\r\nc,d\r\n"), (Rows{ { "a", "b" }, { "c", "d" } }));
+		CHECK_EQ(Parse("a,b\r\nc,d"), (Rows{ { "a", "b" }, { "c", "d" } }));
+		CHECK_EQ(Parse("\"x\r\ny\",z\r\n"), (Rows{ { "x\r\ny", "z" } }));
+		CHECK_EQ(Parse("\"q\"\r\n"), (Rows{ { "q" } }));
+		// blank lines are skipped.
+		CHECK_EQ(Parse("\n\r\na\n\n\r\nb\r\n"), (Rows{ { "a" }, { "b" } }));
+		CHECK_EQ(Parse("a\tb\n", { '\t' }), (Rows{ { "a", "b" } }));
+	}
+	// A quote, delimiter or line end on every offset around the block edges.
+	void TestBlockBoundaries() {
+		for (size_t pad = 0; pad < 140; ++pad) {
+			const std::string lead(pad, 'p');
+			const std::string text = lead + ",\"x,\n\"\"y\",z\r\n\"\",w\n";
+			CHECK_EQ(Parse(text), (Rows{ { lead, "x,\n\"y", "z" }, { "", "w" } }));
+		}
+		// one quoted field spanning several blocks.
+		std::string wide(200, 'q');
+		wide[63] = ',';
+		wide[64] = '\n';
+		wide[127] = '"';
+		CHECK_EQ(Parse("a," + Quote(wide) + ",b\n"), (Rows{ { "a", wide, "b" } }));
+	}
+	// Generated records, parsed back and indexed by every kernel.
+	void TestRandomRecords() {
+		const std::string plain = "ab c";
+		const std::string special = "ab,\"\n\r";
+		for (int round = 0; round < 300; ++round) {
+			Rows expected;
+			std::string text;
+			const size_t records = 1 + test::Below(8);
+			for (size_t r = 0; r < records; ++r) {
+				expected.emplace_back();
+				const size_t fields = 1 + test::Below(5);
+				for (size_t f = 0; f < fields; ++f) {
+					std::string field;
+					const bool quoted = test::Below(2) == 0;
+					const size_t size = test::Below(40) + (fields == 1 ? 1 : 0);
+					for (size_t i = 0; i < size; ++i) {
+						field += quoted ? special[test::Below(special.size())] : plain[test::Below(plain.size())];
+					}
+					text += (f ? "," : "") + (quoted ? Quote(field) : field);
+					expected.back().push_back(field);
+				}
+				if (r + 1 < records || test::Below(2)) {
+					text += test::Below(2) ? "\r\n" : "\n";
+				}
+			}
+			CHECK_EQ(Parse(text), expected);
+
+			std::vector<uint64_t> reference;
+			uint64_t inside{};
+			cpp::detail::Csv_Scanner(',', '"', cpp::detail::SimdLevel::Scalar, false)(text.data(), text.size(), &inside, &reference);
+			for (auto level : { cpp::detail::SimdLevel::Sse2, cpp::detail::SimdLevel::Avx2 }) {
+				if (level > cpp::detail::CurrentSimdLevel()) {
+					continue;
+				}
+				for (bool pclmul : { false, cpp::detail::HasPclmul() }) {
+					std::vector<uint64_t> separators;
+					uint64_t state{};
+					cpp::detail::Csv_Scanner(',', '"', level, pclmul)(text.data(), text.size(), &state, &separators);
+					CHECK(separators == reference);
+					CHECK_EQ(state, inside);
+				}
+			}
+		}
+	}
+}
+
+int main() {
+	TestQuotes();
+	TestLineEndings();
+	TestBlockBoundaries();
+	TestRandomRecords();
+	return test::Report("csv_test");
+}
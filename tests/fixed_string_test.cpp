@@ -0,0 +1,77 @@
+// FixedString and the constexpr Concat, Join, case and Trim forms; most
+// checks are static_asserts, so a regression fails the build.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+	constexpr auto route = cpp::Concat(cpp::FixedString("route:"), "v", 2);
+	static_assert(route == std::string_view("route:v2"), "Concat");
+	// 6 + 1 + the widest int, sign included.
+	static_assert(route.capacity() == 6 + 1 + 11, "Concat capacity");
+	static_assert(cpp::Concat(cpp::FixedString("n"), -42, 'x', int64_t{ INT64_MIN }) == std::string_view("n-42x-9223372036854775808"), "integers");
+	static_assert(cpp::Join(cpp::FixedString("/"), "usr", "local", 7u) == std::string_view("usr/local/7"), "Join");
+	static_assert(cpp::Join('.', cpp::FixedString("a")) == std::string_view("a"), "Join one");
+	static_assert(cpp::ToLower(cpp::FixedString("MiX 9")) == std::string_view("mix 9"), "ToLower");
+	static_assert(cpp::ToUpper(cpp::FixedString("MiX 9")) == std::string_view("MIX 9"), "ToUpper");
+	static_assert(cpp::Trim(cpp::FixedString("  a b  ")) == std::string_view("a b"), "Trim");
+	static_assert(cpp::Trim<cpp::AsciiSpace>(cpp::FixedString("\t a \n")) == std::string_view("a"), "Trim policy");
+	static_assert(cpp::LTrim(cpp::FixedString("  a ")) == std::string_view("a "), "LTrim");
+	static_assert(cpp::RTrim(cpp::FixedString("  a ")) == std::string_view("  a"), "RTrim");
+	static_assert(cpp::Trim(cpp::FixedString("   ")).empty(), "Trim all");
+	static_assert(cpp::FixedString("ab") < cpp::FixedString("b"), "ordering");
+	static_assert(cpp::FixedString(L"w").size() == 1, "wide");
+	// a literal with a NUL inside ends there, as a char buffer does.
+	static_assert(cpp::Concat(cpp::FixedString("k:"), "a\0b") == std::string_view("k:a"), "embedded NUL");
+
+	void TestRuntime() {
+		// a buffer larger than its text: only the text is appended.
+		char buffer[16] = "bob";
+		auto key = cpp::Concat(cpp::FixedString("k:"), buffer);
+		CHECK_EQ(key.size(), size_t{ 5 });
+		CHECK_EQ(key.view(), std::string_view("k:bob"));
+		CHECK_EQ(key.capacity(), size_t{ 17 });
+		buffer[0] = '\0';
+		CHECK_EQ(cpp::Concat(cpp::FixedString("k:"), buffer, 1).str(), std::string("k:1"));
+
+		const std::string user = "alice";
+		auto bounded = cpp::Concat(cpp::FixedString("user:"), cpp::Bounded<8>(user), ':', 7);
+		CHECK_EQ(bounded.str(), std::string("user:alice:7"));
+		CHECK_EQ(std::string(bounded.c_str()), std::string("user:alice:7"));
+		CHECK_EQ(cpp::Join(", ", cpp::Bounded<8>(user), "x").str(), std::string("alice, x"));
+		bool thrown{};
+		try {
+			cpp::Concat(cpp::FixedString("u:"), cpp::Bounded<2>(user));
+		}
+		catch (const std::length_error&) {
+			thrown = true;
+		}
+		CHECK(thrown);
+
+		cpp::FixedString<char, 4> small;
+		small.append("abc", 3).push_back('d');
+		CHECK_EQ(small.view(), std::string_view("abcd"));
+		thrown = false;
+		try {
+			small.push_back('e');
+		}
+		catch (const std::length_error&) {
+			thrown = true;
+		}
+		CHECK(thrown);
+		CHECK_EQ(small.size(), size_t{ 4 });
+		small.clear();
+		CHECK(small.empty() && small.c_str()[0] == '\0');
+
+		// as Format arguments.
+		CHECK_EQ(cpp::Format("{}|{:>5}", route, cpp::Bounded<4>(std::string_view("cd"))), std::string("route:v2|   cd"));
+		CHECK_EQ(cpp::Concat<char>(route, '!'), std::string("route:v2!"));
+	}
+}
+
+int main() {
+	TestRuntime();
+	return test::Report("fixed_string_test");
+}
@@ -0,0 +1,141 @@
+// Format, Concat and Join, through the runtime and compile-time parsed
+// format paths; results are compared with exact expected text.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+namespace {
+	void TestSpecs() {
+		// width, alignment and fill.
+		CHECK_EQ(cpp::Format("{:5}|", 42), std::string("   42|"));
+		CHECK_EQ(cpp::Format("{:<5}|", 42), std::string("42   |"));
+		CHECK_EQ(cpp::Format("{:^6}|", 42), std::string("  42  |"));
+		CHECK_EQ(cpp::Format("{:*^7}|", "ab"), std::string("**ab***|"));
+		CHECK_EQ(cpp::Format("{:5}|{:>3}", 'x', 'y'), std::string("x    |  y"));
+		CHECK_EQ(cpp::Format("{:6}|", std::string("abc")), std::string("abc   |"));
+		CHECK_EQ(cpp::Format("{:2}", "long"), std::string("long"));
+		// sign, '#' and '0'.
+		CHECK_EQ(cpp::Format("{:+d} {: d} {:+} {}", 5, 5, -5, -5), std::string("+5  5 -5 -5"));
+		CHECK_EQ(cpp::Format("{:#x} {:#X} {:#b} {:#o} {:o}", 255, 255, 5, 8, 8), std::string("0xff 0XFF 0b101 010 10"));
+		CHECK_EQ(cpp::Format("{:x} {:X} {:b}", -255, 3054, 0), std::string("-ff BEE 0"));
+		CHECK_EQ(cpp::Format("{:08}|{:+06}|{:#010x}", -42, 42, 255), std::string("-0000042|+00042|0x000000ff"));
+		CHECK_EQ(cpp::Format("{:<06}|{:>06}", 42, 42), std::string("42    |    42"));
+		// precision.
+		CHECK_EQ(cpp::Format("{:.3f}|{:08.3f}|{:>7.2f}", 3.14159, 3.14159, 2.0), std::string("3.142|0003.142|   2.00"));
+		CHECK_EQ(cpp::Format("{:.0f} {:.1f}", 2.5, -0.25), std::string("2 -0.2"));
+		CHECK_EQ(cpp::Format("{:.3}|{:>5.2}|", "abcdef", "xyz"), std::string("abc|   xy|"));
+		CHECK_EQ(cpp::Format("{:.3}", 3.14159), std::string("3.14"));
+		// float types.
+		CHECK_EQ(cpp::Format("{:e} {:E}", 12345.678, 12345.678), std::string("1.234568e+04 1.234568E+04"));
+		CHECK_EQ(cpp::Format("{:g} {:G} {:f}", 0.0001, 1e20, 1.5f), std::string("0.0001 1E+20 1.500000"));
+		CHECK_EQ(cpp::Format("{:+.1e}", 0.5), std::string("+5.0e-01"));
+		// shortest text that reads back the same.
+		CHECK_EQ(cpp::Format("{} {} {} {}", 0.1, 1e300, 1.5f, -0.0), std::string("0.1 1e+300 1.5 -0"));
+		CHECK_EQ(cpp::Format("{}", 0.30000000000000004), std::string("0.30000000000000004"));
+		CHECK_EQ(cpp::Format("{} {:+}", std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()), std::string("inf +inf"));
+		// integers at their limits, bool and char.
+		CHECK_EQ(cpp::Format("{}", std::numeric_limits<int64_t>::min()), std::string("-9223372036854775808"));
+		CHECK_EQ(cpp::Format("{:x}", std::numeric_limits<uint64_t>::max()), std::string("ffffffffffffffff"));
+		CHECK_EQ(cpp::Format("{} {:d} {:>6}|", true, true, false), std::string("true 1  false|"));
+		CHECK_EQ(cpp::Format("{:c}{}", 65, 'b'), std::string("Ab"));
+		// explicit indices; the next implicit field follows the last one used.
+		CHECK_EQ(cpp::Format("{1}-{0}", "a", "b"), std::string("b-a"));
+		CHECK_EQ(cpp::Format("{1}{}{0}", 'a', 'b', 'c'), std::string("bca"));
+		CHECK(cpp::Format(L"{:>4}|{:x}", 7, 255) == L"   7|ff");
+		CHECK_EQ(cpp::Format(std::string("{}:{}"), std::string_view("k"), 1), std::string("k:1"));
+	}
+	void TestCompileTime() {
+		CHECK_EQ(cpp::Format(CPP_FMT("user={} id={1:#06x}"), "ann", 255), std::string("user=ann id=0x00ff"));
+		CHECK_EQ(cpp::Format(CPP_FMT("{:*^7}|{:08.3f}|{:+}"), "ab", 3.14159, 5), std::string("**ab***|0003.142|+5"));
+		CHECK_EQ(cpp::Format(CPP_FMT("{1}-{0}"), 'a', 'b'), std::string("b-a"));
+		CHECK_EQ(cpp::Format(CPP_FMT("no fields")), std::string("no fields"));
+		CHECK(cpp::Format(CPP_FMT(L"{:>4}"), 7) == L"   7");
+		// same text as the runtime parser.
+		const double value = -1234.5678;
+		CHECK_EQ(cpp::Format(CPP_FMT("{:>12.3e}|{:<9}|{:g}"), value, 42, value), cpp::Format("{:>12.3e}|{:<9}|{:g}", value, 42, value));
+		std::string text = "> ";
+		CHECK_EQ(cpp::FormatTo(&text, CPP_FMT("{}/{}"), 1, 2), size_t{ 3 });
+		CHECK_EQ(text, std::string("> 1/2"));
+		constexpr auto scan = cpp::detail::ScanFormat(std::string_view("{}{2:x}{}"));
+		static_assert(scan.ok && scan.fields == 3 && scan.arity == 4, "ScanFormat");
+		static_assert(!cpp::detail::ScanFormat(std::string_view("{:.}")).ok, "malformed precision");
+	}
+	void TestConcatJoin() {
+		CHECK_EQ(cpp::Concat<char>("id=", 42, ',', 1.5, std::string("x"), std::string_view("y"), true), std::string("id=42,1.5xytrue"));
+		CHECK_EQ(cpp::Concat<char>(), std::string());
+		CHECK(cpp::Concat<wchar_t>(L"n", -3) == L"n-3");
+		CHECK_EQ(cpp::Join(',', "a", 1, 2.5), std::string("a,1,2.5"));
+		CHECK_EQ(cpp::Join(','), std::string());
+		CHECK_EQ(cpp::Join(&", ", "a", std::string("b"), 'c'), std::string("a, b, c"));
+	}
+	void TestTo() {
+		std::string text = "keep:";
+		const auto capacity = (text.reserve(64), text.capacity());
+		CHECK_EQ(cpp::ConcatTo(&text, "a", 1), size_t{ 2 });
+		CHECK_EQ(cpp::JoinTo(&text, ", ", 1, 2, 3), size_t{ 7 });
+		CHECK_EQ(cpp::JoinTo(&text, '|', "x", "y"), size_t{ 3 });
+		CHECK_EQ(cpp::FormatTo(&text, "[{:>3}]", 7), size_t{ 5 });
+		CHECK_EQ(text, std::string("keep:a11, 2, 3x|y[  7]"));
+		CHECK_EQ(text.capacity(), capacity);
+
+		std::vector<char> chars;
+		CHECK_EQ(cpp::ConcatTo<char>(std::back_inserter(chars), "ab", 7), size_t{ 3 });
+		CHECK_EQ(cpp::FormatTo(std::back_inserter(chars), "{:03}", 5), size_t{ 3 });
+		CHECK_EQ(cpp::JoinTo(std::back_inserter(chars), '-', 1, 2), size_t{ 3 });
+		CHECK_EQ(std::string(chars.begin(), chars.end()), std::string("ab70051-2"));
+
+		char buffer[16]{};
+		CHECK_EQ(cpp::FormatTo(buffer, "{}+{}", 2, 3), size_t{ 3 });
+		CHECK_EQ(std::string(buffer), std::string("2+3"));
+	}
+	void TestMemoryWriter() {
+		cpp::MemoryWriter<char, 8> writer;
+		CHECK(writer.empty() && writer.inlined());
+		CHECK_EQ(cpp::ConcatTo(&writer, "abc", 12), size_t{ 5 });
+		CHECK(writer.inlined());
+		CHECK_EQ(writer.view(), std::string_view("abc12"));
+		CHECK_EQ(cpp::FormatTo(&writer, "|{:>6}|", "x"), size_t{ 8 });
+		CHECK(!writer.inlined());
+		CHECK_EQ(writer.str(), std::string("abc12|     x|"));
+		writer.push_back('!');
+		CHECK_EQ(writer.size(), size_t{ 14 });
+		// clear keeps the heap buffer for the next round.
+		const auto capacity = writer.capacity();
+		for (int round = 0; round < 100; ++round) {
+			writer.clear();
+			cpp::JoinTo(&writer, ',', round, round * 2);
+			CHECK_EQ(writer.str(), cpp::Format("{},{}", round, round * 2));
+		}
+		CHECK_EQ(writer.capacity(), capacity);
+		writer.reserve(1000);
+		CHECK(writer.capacity() >= 1000);
+		CHECK_EQ(writer.view(), std::string_view("99,198"));
+
+		cpp::MemoryWriter<wchar_t, 4> wide;
+		cpp::FormatTo(&wide, L"{}-{}", L"ab", 12345);
+		CHECK(wide.view() == L"ab-12345");
+	}
+	void TestBadIndex() {
+		// fields past the last argument are kept as written.
+		CHECK_EQ(cpp::Format("a{}b{3}c", 1), std::string("a1b{3}c"));
+		CHECK_EQ(cpp::Format("{1:>4}|{0}", 'x'), std::string("{1:>4}|x"));
+		CHECK_EQ(cpp::Format("{}{}", 7), std::string("7{}"));
+		CHECK_EQ(cpp::Format("{0}"), std::string("{0}"));
+		std::string text = "=";
+		CHECK_EQ(cpp::FormatTo(&text, "{2}", 1, 2), size_t{ 3 });
+		CHECK_EQ(text, std::string("={2}"));
+	}
+}
+
+int main() {
+	TestSpecs();
+	TestCompileTime();
+	TestConcatJoin();
+	TestTo();
+	TestMemoryWriter();
+	TestBadIndex();
+	return test::Report("format_test");
+}
@@ -0,0 +1,58 @@
+// Per-API counters, built with STRING_UTIL_INSTRUMENT: every public call is
+// counted once, under its own API, with the elements it read.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+namespace {
+	using cpp::StringApi;
+
+	cpp::ApiStats Delta(StringApi api, const cpp::InstrumentSnapshot& before) {
+		return cpp::instrument::Delta(cpp::instrument::Snapshot(), before)[api];
+	}
+
+	void TestReplaceCountsOnce() {
+		cpp::MultiReplacer replacer({ { "cat", "dog" }, { "a", "A" } });
+		const std::string text = "a cat";
+		const auto before = cpp::instrument::Snapshot();
+		CHECK_EQ(replacer.ReplaceAll(text), std::string("A dog"));
+		const auto replace = Delta(StringApi::MultiReplace, before);
+		CHECK_EQ(replace.calls, uint64_t{ 1 });
+		CHECK_EQ(replace.bytesIn, uint64_t{ text.size() });
+		CHECK_EQ(replace.tokens, uint64_t{ 2 });
+		CHECK_EQ(Delta(StringApi::MultiMatch, before).calls, uint64_t{ 0 });
+
+		cpp::MultiMatcher matcher({ "a" });
+		const auto found = cpp::instrument::Snapshot();
+		CHECK_EQ(matcher.FindAll(text).size(), size_t{ 2 });
+		CHECK_EQ(Delta(StringApi::MultiMatch, found).calls, uint64_t{ 1 });
+		CHECK_EQ(Delta(StringApi::MultiMatch, found).bytesIn, uint64_t{ text.size() });
+	}
+	void TestStreamBytesIn() {
+		const std::string text = "one,two,three";
+		const auto before = cpp::instrument::Snapshot();
+		size_t count = cpp::StreamSplit(cpp::MemorySource<char>{ text.data(), text.data() + text.size() }, ',', [](std::string_view) {}, 4);
+		CHECK_EQ(count, size_t{ 3 });
+		const auto stream = Delta(StringApi::StreamSplit, before);
+		CHECK_EQ(stream.calls, uint64_t{ 1 });
+		CHECK_EQ(stream.bytesIn, uint64_t{ text.size() });
+		CHECK_EQ(stream.bytesOut, uint64_t{ 11 });
+		CHECK_EQ(stream.tokens, uint64_t{ 3 });
+	}
+	void TestSplitCountsOnce() {
+		const std::string text = "a,b,c";
+		const auto before = cpp::instrument::Snapshot();
+		CHECK_EQ(cpp::Split(text, ',').size(), size_t{ 3 });
+		const auto split = Delta(StringApi::Split, before);
+		CHECK_EQ(split.calls, uint64_t{ 1 });
+		CHECK_EQ(split.bytesIn, uint64_t{ text.size() });
+		CHECK_EQ(split.tokens, uint64_t{ 3 });
+	}
+}
+
+int main() {
+	static_assert(cpp::instrument::Enabled, "build with STRING_UTIL_INSTRUMENT.");
+	TestReplaceCountsOnce();
+	TestStreamBytesIn();
+	TestSplitCountsOnce();
+	return test::Report("instrument_test");
+}
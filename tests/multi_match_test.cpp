@@ -0,0 +1,151 @@
+// MultiMatcher overlap reporting and leftmost-longest selection, checked
+// against brute force over small alphabets where needles nest and overlap.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+#include <algorithm>
+
+namespace {
+	using Match = std::tuple<size_t, size_t, size_t>;	// position, length, pattern.
+
+	std::vector<Match> Tuples(const std::vector<cpp::MultiMatch>& matches) {
+		std::vector<Match> tuples;
+		for (const auto& match : matches) {
+			tuples.emplace_back(match.position, match.length, match.pattern);
+		}
+		return tuples;
+	}
+	std::vector<Match> AllOverlapping(const cpp::MultiMatcher& matcher, std::string_view text) {
+		std::vector<cpp::MultiMatch> matches;
+		matcher.ForEach(text, [&](const cpp::MultiMatch& match) {
+			matches.push_back(match);
+		});
+		auto tuples = Tuples(matches);
+		std::sort(tuples.begin(), tuples.end());
+		return tuples;
+	}
+	// Lowest index wins among equal needles, as in the automaton.
+	std::vector<Match> BruteOverlapping(const std::vector<std::string>& needles, std::string_view text) {
+		std::vector<Match> matches;
+		for (size_t pos = 0; pos < text.size(); ++pos) {
+			for (size_t index = 0; index < needles.size(); ++index) {
+				const auto& needle = needles[index];
+				if (needle.empty() || text.compare(pos, needle.size(), needle) != 0) {
+					continue;
+				}
+				if (std::find(needles.begin(), needles.begin() + static_cast<std::ptrdiff_t>(index), needle) == needles.begin() + static_cast<std::ptrdiff_t>(index)) {
+					matches.emplace_back(pos, needle.size(), index);
+				}
+			}
+		}
+		std::sort(matches.begin(), matches.end());
+		return matches;
+	}
+	std::vector<Match> BruteLeftmostLongest(const std::vector<std::string>& needles, std::string_view text) {
+		std::vector<Match> matches;
+		size_t pos = 0;
+		while (pos < text.size()) {
+			size_t best = needles.size();
+			for (size_t index = 0; index < needles.size(); ++index) {
+				const auto& needle = needles[index];
+				if (!needle.empty() && text.compare(pos, needle.size(), needle) == 0 && (best == needles.size() || needle.size() > needles[best].size())) {
+					best = index;
+				}
+			}
+			if (best == needles.size()) {
+				++pos;
+				continue;
+			}
+			matches.emplace_back(pos, needles[best].size(), best);
+			pos += needles[best].size();
+		}
+		return matches;
+	}
+
+	void TestOverlap() {
+		cpp::MultiMatcher matcher({ "he", "she", "his", "hers" });
+		CHECK_EQ(AllOverlapping(matcher, "ushers").size(), size_t{ 3 });
+		CHECK(AllOverlapping(matcher, "ushers") == (std::vector<Match>{ { 1, 3, 1 }, { 2, 2, 0 }, { 2, 4, 3 } }));
+		CHECK(matcher.Contains("this"));
+		CHECK(!matcher.Contains("hxs"));
+		size_t seen{};
+		matcher.ForEach("hehehe", [&](const cpp::MultiMatch&) {
+			return ++seen < 2;
+		});
+		CHECK_EQ(seen, size_t{ 2 });
+	}
+	void TestLeftmostLongest() {
+		cpp::MultiMatcher nested({ "a", "aa", "aaa" });
+		CHECK(Tuples(nested.FindAll("aaaaaaa")) == (std::vector<Match>{ { 0, 3, 2 }, { 3, 3, 2 }, { 6, 1, 0 } }));
+		// an earlier start beats a longer match that starts later.
+		cpp::MultiMatcher early({ "abc", "bcdef" });
+		CHECK(Tuples(early.FindAll("abcdef")) == (std::vector<Match>{ { 0, 3, 0 } }));
+		// a longer candidate that fails falls back to the shorter one inside it.
+		cpp::MultiMatcher fallback({ "b", "abc" });
+		CHECK(Tuples(fallback.FindAll("abd")) == (std::vector<Match>{ { 1, 1, 0 } }));
+		cpp::MultiMatcher shorter({ "abcd", "bc" });
+		CHECK(Tuples(shorter.FindAll("abcd")) == (std::vector<Match>{ { 0, 4, 0 } }));
+		CHECK(Tuples(shorter.FindAll("abce")) == (std::vector<Match>{ { 1, 2, 1 } }));
+
+		cpp::MultiMatcher folded({ "Hello" }, { true });
+		CHECK(Tuples(folded.FindAll("say HELLO, hello")) == (std::vector<Match>{ { 4, 5, 0 }, { 11, 5, 0 } }));
+	}
+	void TestRandom() {
+		for (int round = 0; round < 400; ++round) {
+			const std::string alphabet = round % 2 ? "ab" : "abc";
+			std::vector<std::string> needles(1 + test::Below(6));
+			for (auto& needle : needles) {
+				needle.resize(1 + test::Below(5));
+				for (auto& ch : needle) {
+					ch = alphabet[test::Below(alphabet.size())];
+				}
+			}
+			std::string text(test::Below(120), ' ');
+			for (auto& ch : text) {
+				ch = alphabet[test::Below(alphabet.size())];
+			}
+			cpp::MultiMatcher matcher(needles);
+			CHECK(AllOverlapping(matcher, text) == BruteOverlapping(needles, text));
+			auto kept = BruteLeftmostLongest(needles, text);
+			auto found = Tuples(matcher.FindAll(text));
+			// equal needles may report either index; compare spans.
+			CHECK_EQ(found.size(), kept.size());
+			for (size_t i = 0; i < std::min(found.size(), kept.size()); ++i) {
+				CHECK_EQ(std::get<0>(found[i]), std::get<0>(kept[i]));
+				CHECK_EQ(std::get<1>(found[i]), std::get<1>(kept[i]));
+			}
+		}
+	}
+	// More first bytes than the SSE2 prefilter takes; AVX2 still jumps.
+	void TestManyFirstBytes() {
+		const std::string firsts = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789#$%&";
+		std::vector<std::string> needles;
+		for (char first : firsts) {
+			needles.push_back(std::string(1, first) + "ab");
+		}
+		needles.push_back("Zab!");
+		std::string text(3000, 'x');
+		for (size_t i = 0; i < 60; ++i) {
+			text.replace(test::Below(text.size() - 4), 4, needles[test::Below(needles.size())]);
+		}
+		cpp::MultiMatcher matcher(needles);
+		CHECK(AllOverlapping(matcher, text) == BruteOverlapping(needles, text));
+		CHECK(Tuples(matcher.FindAll(text)) == BruteLeftmostLongest(needles, text));
+	}
+	void TestReplace() {
+		cpp::MultiReplacer replacer({ { "cat", "dog" }, { "category", "kind" }, { "a", "A" } });
+		CHECK_EQ(replacer.ReplaceAll("a cat in a category"), std::string("A dog in A kind"));
+		std::string text = "no match here";
+		CHECK_EQ(cpp::MultiReplacer({ { "xyz", "" } }).ReplaceAll(&text), size_t{ 0 });
+		CHECK_EQ(text, std::string("no match here"));
+	}
+}
+
+int main() {
+	TestOverlap();
+	TestLeftmostLongest();
+	TestRandom();
+	TestManyFirstBytes();
+	TestReplace();
+	return test::Report("multi_match_test");
+}
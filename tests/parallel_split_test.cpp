@@ -0,0 +1,76 @@
+// ParallelSplit with the serial threshold off, so that range cuts land on,
+// next to and between delimiters; results must match Split exactly.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+namespace {
+	cpp::ParallelOptions Options(size_t threads) {
+		cpp::ParallelOptions options;
+		options.threads = threads;
+		options.serialThreshold = 1;
+		return options;
+	}
+	std::string RandomText(size_t size, const std::string& alphabet) {
+		std::string text(size, ' ');
+		for (auto& ch : text) {
+			ch = alphabet[test::Below(alphabet.size())];
+		}
+		return text;
+	}
+
+	void TestBoundaries() {
+		for (size_t threads : { 2, 3, 8 }) {
+			const auto options = Options(threads);
+			for (size_t size = 0; size < 160; ++size) {
+				// dense, sparse and no delimiters.
+				for (const std::string alphabet : { ",", ",a", "aaaaaaa,", "a" }) {
+					const auto text = RandomText(size, alphabet);
+					CHECK_EQ(cpp::ParallelSplit(text, ',', options), cpp::Split(text, ','));
+					std::vector<std::string_view> views;
+					cpp::ParallelSplit(std::string_view(text), ',', &views, options);
+					CHECK_EQ(views.size(), cpp::Split(text, ',').size());
+				}
+			}
+		}
+		const auto options = Options(4);
+		CHECK_EQ(cpp::ParallelSplit(std::string(",x,"), ',', options), (std::vector<std::string>{ "", "x", "" }));
+		CHECK_EQ(cpp::ParallelSplit(std::string("a;b,c"), ",;", options), (std::vector<std::string>{ "a", "b", "c" }));
+		CHECK_EQ(cpp::ParallelSplitTrim(std::string(" a , b ,c "), ',', options), (std::vector<std::string>{ "a", "b", "c" }));
+	}
+	void TestAppendAndExecutor() {
+		const auto text = RandomText(1000, "ab,");
+		auto expected = cpp::Split(text, ',');
+		expected.insert(expected.begin(), "kept");
+		std::vector<std::string> tokens{ "kept" };
+		auto options = Options(4);
+		// tasks run in reverse order on the caller.
+		options.executor = [](size_t count, const std::function<void(size_t)>& task) {
+			for (size_t i = count; i--;) {
+				task(i);
+			}
+		};
+		cpp::ParallelSplit(text, ',', &tokens, options);
+		CHECK_EQ(tokens, expected);
+	}
+	void TestTaskError() {
+		auto options = Options(4);
+		options.executor = [](size_t, const std::function<void(size_t)>&) {
+			throw std::runtime_error("executor");
+		};
+		bool thrown{};
+		try {
+			cpp::ParallelSplit(RandomText(100, "a,"), ',', options);
+		}
+		catch (const std::runtime_error&) {
+			thrown = true;
+		}
+		CHECK(thrown);
+	}
+}
+
+int main() {
+	TestBoundaries();
+	TestAppendAndExecutor();
+	TestTaskError();
+	return test::Report("parallel_split_test");
+}
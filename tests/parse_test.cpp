@@ -0,0 +1,117 @@
+// SplitAs and ParseFields: values, the std::errc reported per field, trim
+// policies, and which calls on a temporary line are refused.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+#include <cstdint>
+
+namespace {
+	// Whether SplitAs<_Type>(std::string&&, ',') is callable.
+	template <class _Type, class = void>
+	struct Splits_Temporary : std::false_type {};
+	template <class _Type>
+	struct Splits_Temporary<_Type, std::void_t<decltype(cpp::SplitAs<_Type>(std::string(), ','))>> : std::true_type {};
+	template <class _Type, class = void>
+	struct Parses_Temporary : std::false_type {};
+	template <class _Type>
+	struct Parses_Temporary<_Type, std::void_t<decltype(cpp::ParseFields<_Type>(std::string(), ','))>> : std::true_type {};
+
+	// Whether ParseFields<int>(line, ',', _Arg{}) is callable.
+	template <class _Arg, class = void>
+	struct Takes_Third : std::false_type {};
+	template <class _Arg>
+	struct Takes_Third<_Arg, std::void_t<decltype(cpp::ParseFields<int>(std::string_view(), ',', std::declval<_Arg>()))>> : std::true_type {};
+
+	void TestSplitAs() {
+		CHECK_EQ(cpp::SplitAs<int>(std::string_view("1,-2,+3"), ','), (std::vector<int>{ 1, -2, 3 }));
+		CHECK_EQ(cpp::SplitAs<double>(std::string("1.5;-2e3|0"), ";|"), (std::vector<double>{ 1.5, -2000, 0 }));
+		CHECK_EQ(cpp::SplitAs<std::string_view>(std::string_view("a,,b"), ','), (std::vector<std::string_view>{ "a", "", "b" }));
+		CHECK_EQ(cpp::SplitAs<std::string>(std::string("x y"), ' '), (std::vector<std::string>{ "x", "y" }));
+		CHECK_EQ((cpp::SplitAs<int, cpp::AsciiSpace>(std::string(" 1 ,\t2\n"), ',')), (std::vector<int>{ 1, 2 }));
+
+		// failed fields keep their slot, value-initialized.
+		cpp::FieldsResult result;
+		std::vector<int> values;
+		std::vector<cpp::FieldError> errors;
+		result = cpp::SplitAs(std::string_view("7,x,99999999999,,+-1,2 "), ',', &values, &errors);
+		CHECK(!result);
+		CHECK_EQ(result.count, size_t{ 6 });
+		CHECK_EQ(result.failed, size_t{ 5 });
+		CHECK_EQ(result.firstFailed, size_t{ 1 });
+		CHECK(result.error == std::errc::invalid_argument);
+		CHECK_EQ(values, (std::vector<int>{ 7, 0, 0, 0, 0, 0 }));
+		CHECK_EQ(errors.size(), size_t{ 5 });
+		CHECK(errors[0].field == 1 && errors[0].error == std::errc::invalid_argument);
+		CHECK(errors[1].field == 2 && errors[1].error == std::errc::result_out_of_range);
+		CHECK(errors[2].field == 3 && errors[2].error == std::errc::invalid_argument);
+		CHECK(errors[4].field == 5 && errors[4].error == std::errc::invalid_argument);
+
+		// into a fixed array: fields past the capacity are value_too_large.
+		int fixed[2]{ -1, -1 };
+		result = cpp::SplitAs(std::string_view("4,5,6"), ',', fixed, 2);
+		CHECK_EQ(result.count, size_t{ 3 });
+		CHECK_EQ(result.failed, size_t{ 1 });
+		CHECK(result.firstFailed == 2 && result.error == std::errc::value_too_large);
+		CHECK(fixed[0] == 4 && fixed[1] == 5);
+
+		result = {};
+		auto small = cpp::SplitAs<uint8_t>(std::string("255,256"), ',', &result);
+		CHECK(small[0] == 255 && small[1] == 0);
+		CHECK(result.error == std::errc::result_out_of_range);
+
+		// wide tokens are narrowed; anything outside ASCII is not a number.
+		CHECK_EQ(cpp::SplitAs<int>(std::wstring_view(L"1,22"), L','), (std::vector<int>{ 1, 22 }));
+		result = {};
+		cpp::SplitAs<int>(std::wstring_view(L"\u0661,3"), L',', &result);
+		CHECK(result.failed == 1 && result.error == std::errc::invalid_argument);
+	}
+	void TestParseFields() {
+		auto fields = cpp::ParseFields<int64_t, double, std::string_view>(std::string_view("7,2.5,name"), ',');
+		CHECK(fields.ok());
+		CHECK_EQ(std::get<0>(fields.values), int64_t{ 7 });
+		CHECK_EQ(std::get<1>(fields.values), 2.5);
+		CHECK_EQ(std::get<2>(fields.values), std::string_view("name"));
+
+		// missing fields are invalid_argument, extra ones only counted.
+		auto missing = cpp::ParseFields<int, int>(std::string("1"), ',');
+		CHECK(!missing);
+		CHECK_EQ(missing.count, size_t{ 1 });
+		CHECK(missing.errors[0] == std::errc{} && missing.errors[1] == std::errc::invalid_argument);
+		auto extra = cpp::ParseFields<int, int>(std::string("1,2,3"), ',');
+		CHECK(!extra);
+		CHECK_EQ(extra.count, size_t{ 3 });
+		CHECK(extra.errors[0] == std::errc{} && extra.errors[1] == std::errc{});
+
+		auto overflow = cpp::ParseFields<uint8_t, float>(std::string("300,abc"), ',');
+		CHECK(overflow.errors[0] == std::errc::result_out_of_range && overflow.errors[1] == std::errc::invalid_argument);
+
+		const std::string line = " 1 ;\t2.5 ";
+		auto trimmed = cpp::ParseFields<int, double>(line, ';', cpp::AsciiSpace{});
+		CHECK(trimmed.ok());
+		CHECK(std::get<0>(trimmed.values) == 1 && std::get<1>(trimmed.values) == 2.5);
+		CHECK(!(cpp::ParseFields<int, double>(line, ';').ok()));
+
+		int id{};
+		double value{};
+		CHECK(cpp::ParseFields(std::string_view("3,4.5"), ',', &id, &value).ok());
+		CHECK(id == 3 && value == 4.5);
+		CHECK(cpp::ParseFields(line, ";", cpp::AsciiSpace{}, &id, &value).ok());
+		CHECK(id == 1 && value == 2.5);
+	}
+	void TestTemporaries() {
+		static_assert(Splits_Temporary<int>::value && Splits_Temporary<std::string>::value, "owning results from a temporary");
+		static_assert(!Splits_Temporary<std::string_view>::value, "views into a temporary");
+		static_assert(Parses_Temporary<double>::value, "owning results from a temporary");
+		static_assert(!Parses_Temporary<std::string_view>::value, "views into a temporary");
+		// only trim policies and output pointers follow the delimiter.
+		static_assert(Takes_Third<cpp::AsciiSpace>::value && Takes_Third<int*>::value, "policy or pointer");
+		static_assert(!Takes_Third<int>::value && !Takes_Third<std::string>::value, "not a policy");
+	}
+}
+
+int main() {
+	TestSplitAs();
+	TestParseFields();
+	TestTemporaries();
+	return test::Report("parse_test");
+}
@@ -0,0 +1,143 @@
+// Split and SplitView against a reference tokenizer, and the scalar, SSE2
+// and AVX2 delimiter scanners against each other.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+#include <algorithm>
+
+namespace {
+	using cpp::detail::Byte_Scanner;
+	using cpp::detail::SimdLevel;
+
+	std::vector<std::string> Reference(const std::string& text, std::string_view delims) {
+		std::vector<std::string> tokens(1);
+		for (char ch : text) {
+			if (delims.find(ch) != delims.npos) {
+				tokens.emplace_back();
+			}
+			else {
+				tokens.back() += ch;
+			}
+		}
+		return tokens;
+	}
+	std::vector<SimdLevel> Levels() {
+		std::vector<SimdLevel> levels{ SimdLevel::Scalar };
+#if defined(STRING_UTIL_X86)
+		if (cpp::detail::CurrentSimdLevel() != SimdLevel::Scalar) {
+			levels.push_back(SimdLevel::Sse2);
+		}
+		if (cpp::detail::CurrentSimdLevel() == SimdLevel::Avx2) {
+			levels.push_back(SimdLevel::Avx2);
+		}
+#endif
+		return levels;
+	}
+	// Every hit, once through Collect and once through repeated scans.
+	std::vector<size_t> Collected(const Byte_Scanner& scanner, const std::string& text) {
+		const char* positions[Byte_Scanner::Collect_Capacity];
+		std::vector<size_t> hits;
+		const char* scan = text.data();
+		const char* last = text.data() + text.size();
+		while (scan != last) {
+			size_t count{};
+			scan = scanner.Collect(scan, last, positions, &count);
+			for (size_t i = 0; i < count; ++i) {
+				hits.push_back(static_cast<size_t>(positions[i] - text.data()));
+			}
+		}
+		return hits;
+	}
+	std::vector<size_t> Scanned(const Byte_Scanner& scanner, const std::string& text) {
+		std::vector<size_t> hits;
+		const char* first = text.data();
+		const char* last = text.data() + text.size();
+		while ((first = scanner(first, last)) != last) {
+			hits.push_back(static_cast<size_t>(first - text.data()));
+			++first;
+		}
+		return hits;
+	}
+	std::string RandomText(size_t size, const std::string& alphabet) {
+		std::string text(size, ' ');
+		for (auto& ch : text) {
+			ch = alphabet[test::Below(alphabet.size())];
+		}
+		return text;
+	}
+
+	void TestScannerLevels() {
+		const std::string sets[] = {
+			std::string(), std::string(","), std::string(",;"), std::string(",; \t"), std::string(",; \t|"),
+			std::string("\x80\xff", 2), std::string(",\x80", 2), std::string("abcdefghijklmnop"),
+			std::string("abcdefghijklmnopq"), std::string("\0", 1), std::string("\0,", 2),
+		};
+		const std::string alphabet("abcxyz,; \t|\x80\xff\0", 15);
+		for (const auto& set : sets) {
+			for (size_t size : { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 300, 1000 }) {
+				const auto text = RandomText(size, alphabet);
+				std::vector<size_t> expected;
+				for (size_t i = 0; i < text.size(); ++i) {
+					if (set.find(text[i]) != set.npos) {
+						expected.push_back(i);
+					}
+				}
+				for (auto level : Levels()) {
+					Byte_Scanner scanner(set.data(), set.size(), level);
+					CHECK_EQ(Collected(scanner, text), expected);
+					CHECK_EQ(Scanned(scanner, text), expected);
+				}
+			}
+		}
+	}
+	void TestSplit() {
+		const std::string alphabet("ab,;: ");
+		for (size_t size = 0; size < 200; ++size) {
+			const auto text = RandomText(size, alphabet);
+			CHECK_EQ(cpp::Split(text, ','), Reference(text, ","));
+			CHECK_EQ(cpp::Split(text, ",;:"), Reference(text, ",;:"));
+			std::vector<std::string> viewed;
+			for (auto token : cpp::SplitView(text, ',')) {
+				viewed.emplace_back(token);
+			}
+			CHECK_EQ(viewed, Reference(text, ","));
+		}
+		CHECK_EQ(cpp::Split(std::string(), ','), std::vector<std::string>{ "" });
+		CHECK_EQ(cpp::Split(std::string(",,"), ','), (std::vector<std::string>{ "", "", "" }));
+		CHECK_EQ(cpp::SplitTrim(std::string(" a , b ,c "), ','), (std::vector<std::string>{ "a", "b", "c" }));
+		// an empty set matches nothing, NUL bytes included.
+		std::string nul(100, 'x');
+		nul[40] = '\0';
+		CHECK_EQ(cpp::Split(nul, ""), std::vector<std::string>{ nul });
+	}
+	void TestArena() {
+		cpp::TokenArena<char> arena;
+		cpp::Split(std::string("d,b,a,c"), ',', &arena);
+		CHECK_EQ(arena.size(), size_t{ 4 });
+		auto first = arena.begin();
+		auto last = arena.end();
+		CHECK(1 + first == first + 1);
+		CHECK(last - first == 4);
+		CHECK(first < last && last > first && first <= first && last >= first);
+		CHECK(!(first >= last) && !(last <= first));
+		CHECK_EQ(first[2], std::string_view("a"));
+		std::vector<std::string_view> sorted(first, last);
+		std::sort(sorted.begin(), sorted.end());
+		CHECK(std::is_sorted(sorted.begin(), sorted.end()));
+		CHECK_EQ(*std::max_element(first, last), std::string_view("d"));
+		CHECK(std::distance(first, std::find(first, last, std::string_view("c"))) == 3);
+	}
+	void TestWide() {
+		const std::wstring text = L"a,b;;c";
+		auto tokens = cpp::Split(text, L";,");
+		CHECK(tokens == (std::vector<std::wstring>{ L"a", L"b", L"", L"c" }));
+	}
+}
+
+int main() {
+	TestScannerLevels();
+	TestSplit();
+	TestArena();
+	TestWide();
+	return test::Report("split_test");
+}
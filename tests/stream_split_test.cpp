@@ -0,0 +1,124 @@
+// StreamSplit over sources whose chunks are much smaller than the tokens,
+// so that the carry-over and buffer growth paths run; results must match
+// Split on the whole input.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+	template<class _Source, class _Delim>
+	std::vector<std::string> Streamed(_Source&& source, _Delim delim, size_t chunkSize) {
+		std::vector<std::string> tokens;
+		cpp::StreamSplit(std::forward<_Source>(source), delim, [&](std::string_view token) {
+			tokens.emplace_back(token);
+		}, chunkSize);
+		return tokens;
+	}
+	// Up to 16 tokens of up to 40 characters, empty ones included.
+	std::string RandomText() {
+		std::string text;
+		const size_t tokens = test::Below(16);
+		for (size_t i = 0; i < tokens; ++i) {
+			text.append(test::Below(40), static_cast<char>('a' + test::Below(26)));
+			text += test::Below(3) ? ',' : ';';
+		}
+		text.append(test::Below(3), 'z');
+		return text;
+	}
+
+	void TestGrowth() {
+		for (int round = 0; round < 200; ++round) {
+			const auto text = RandomText();
+			const auto expected = cpp::Split(text, ',');
+			const auto expectedSet = cpp::Split(text, ",;");
+			for (size_t chunk : { 1, 2, 3, 7, 64, 4096 }) {
+				CHECK_EQ(Streamed(cpp::MemorySource<char>{ text.data(), text.data() + text.size() }, ',', chunk), expected);
+				CHECK_EQ(Streamed(cpp::MemorySource<char>{ text.data(), text.data() + text.size() }, ",;", chunk), expectedSet);
+				std::istringstream stream(text);
+				CHECK_EQ(Streamed(stream, ',', chunk), expected);
+			}
+		}
+		// one token many times the chunk size.
+		const std::string big(10000, 'x');
+		CHECK_EQ(Streamed(cpp::MemorySource<char>{ big.data(), big.data() + big.size() }, ',', 16), std::vector<std::string>{ big });
+	}
+	void TestTrimAndView() {
+		const std::string text = " a , b,,c ";
+		std::vector<std::string> tokens;
+		size_t count = cpp::StreamSplitTrim(cpp::MemorySource<char>{ text.data(), text.data() + text.size() }, ',', [&](std::string_view token) {
+			tokens.emplace_back(token);
+		}, 2);
+		CHECK_EQ(count, size_t{ 4 });
+		CHECK_EQ(tokens, (std::vector<std::string>{ "a", "b", "", "c" }));
+
+		std::vector<std::string> viewed;
+		for (auto token : cpp::StreamSplitView(cpp::MemorySource<char>{ text.data(), text.data() + text.size() }, ',', 3)) {
+			viewed.emplace_back(token);
+		}
+		CHECK_EQ(viewed, cpp::Split(text, ','));
+		CHECK_EQ(Streamed(cpp::MemorySource<char>{ text.data(), text.data() }, ',', 4), std::vector<std::string>{ "" });
+	}
+	// Hands out "ab," a few times, then throws as a failing device would.
+	struct Failing_Buffer : std::streambuf {
+		char chunk[3]{ 'a', 'b', ',' };
+		int left{ 3 };
+
+		int_type underflow() override {
+			if (left-- == 0) {
+				throw std::runtime_error("device");
+			}
+			setg(chunk, chunk, chunk + sizeof(chunk));
+			return traits_type::to_int_type(chunk[0]);
+		}
+	};
+	void TestIstreamError() {
+		Failing_Buffer buffer;
+		std::istream stream(&buffer);
+		std::vector<std::string> tokens;
+		bool thrown{};
+		try {
+			cpp::StreamSplit(stream, ',', [&](std::string_view token) {
+				tokens.emplace_back(token);
+			}, 4);
+		}
+		catch (const std::ios_base::failure&) {
+			thrown = true;
+		}
+		CHECK(thrown);
+		CHECK(stream.bad());
+		CHECK(tokens.size() <= 3);
+		for (const auto& token : tokens) {
+			CHECK_EQ(token, std::string("ab"));
+		}
+	}
+	void TestFd() {
+#if defined(STRING_UTIL_POSIX)
+		int fds[2];
+		CHECK(::pipe(fds) == 0);
+		const std::string text = "one,two,three";
+		CHECK(::write(fds[1], text.data(), text.size()) == static_cast<ssize_t>(text.size()));
+		::close(fds[1]);
+		CHECK_EQ(Streamed(cpp::FdSource{ fds[0] }, ',', 4), cpp::Split(text, ','));
+		::close(fds[0]);
+		// a failed read is an error, not the end of the input.
+		int error{};
+		try {
+			Streamed(cpp::FdSource{ fds[0] }, ',', 4);
+		}
+		catch (const std::system_error& e) {
+			error = e.code().value();
+		}
+		CHECK_EQ(error, EBADF);
+#endif
+	}
+}
+
+int main() {
+	TestGrowth();
+	TestTrimAndView();
+	TestIstreamError();
+	TestFd();
+	return test::Report("stream_split_test");
+}
@@ -0,0 +1,62 @@
+// StringPool and ShardedStringPool ids, views and moves.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+namespace {
+	void TestIntern() {
+		cpp::StringPool<char> pool(16);
+		const auto a = pool.Intern("alpha");
+		const auto b = pool.Intern("beta");
+		CHECK_EQ(pool.Intern("alpha"), a);
+		CHECK(a != b);
+		CHECK_EQ(pool[b], std::string_view("beta"));
+		CHECK_EQ(pool.Find("gamma"), cpp::StringPool<char>::npos);
+		// larger than a chunk: stored in its own block.
+		const std::string big(100, 'x');
+		CHECK_EQ(pool.InternView(big), std::string_view(big));
+		CHECK_EQ(pool.size(), size_t{ 3 });
+
+		std::vector<uint32_t> ids;
+		cpp::Split(std::string("b,a,b,c"), ',', &pool, &ids);
+		CHECK_EQ(ids.size(), size_t{ 4 });
+		CHECK_EQ(ids[0], ids[2]);
+		CHECK_EQ(pool[ids[3]], std::string_view("c"));
+	}
+	// A moved-from pool is empty and keeps working.
+	void TestMove() {
+		cpp::StringPool<char> source(8);
+		const auto id = source.Intern("k1");
+		const auto view = source[id];
+		cpp::StringPool<char> target(std::move(source));
+		CHECK_EQ(target[id], std::string_view("k1"));
+		CHECK_EQ(target[id].data(), view.data());
+		CHECK(source.empty());
+		CHECK_EQ(source.Find("k1"), cpp::StringPool<char>::npos);
+		CHECK_EQ(source.Intern("ab"), uint32_t{ 0 });
+		CHECK_EQ(source[0], std::string_view("ab"));
+
+		cpp::StringPool<char> assigned;
+		assigned.Intern("old");
+		assigned = std::move(target);
+		CHECK_EQ(assigned.size(), size_t{ 1 });
+		CHECK_EQ(assigned[id], std::string_view("k1"));
+		CHECK_EQ(target.InternView("again"), std::string_view("again"));
+	}
+	void TestSharded() {
+		cpp::ShardedStringPool<char> pool;
+		std::vector<uint32_t> ids;
+		cpp::Split(std::string("x,y,x,z,y"), ',', &pool, &ids);
+		CHECK_EQ(ids.size(), size_t{ 5 });
+		CHECK_EQ(ids[0], ids[2]);
+		CHECK_EQ(ids[1], ids[4]);
+		CHECK_EQ(pool[ids[3]], std::string_view("z"));
+		CHECK_EQ(pool.size(), size_t{ 3 });
+	}
+}
+
+int main() {
+	TestIntern();
+	TestMove();
+	TestSharded();
+	return test::Report("string_pool_test");
+}
@@ -0,0 +1,64 @@
+#pragma once
+// Minimal checks for the behaviour tests: a failed CHECK prints where and
+// what, and Report() turns the failure count into the exit code.
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace test {
+	inline int& Failures() {
+		static int failures{};
+		return failures;
+	}
+	inline void Fail(const char* file, int line, const std::string& what) {
+		std::fprintf(stderr, "%s:%d: %s\n", file, line, what.c_str());
+		++Failures();
+	}
+	template<class _Type>
+	std::string Show(const _Type& value) {
+		std::ostringstream out;
+		out << value;
+		return out.str();
+	}
+	template<class _Type>
+	std::string Show(const std::vector<_Type>& values) {
+		std::string text = "[";
+		for (size_t i = 0; i < values.size(); ++i) {
+			text += (i ? ", " : "") + Show(values[i]);
+		}
+		return text + "]";
+	}
+	inline int Report(const char* name) {
+		if (Failures()) {
+			std::fprintf(stderr, "%s: %d check(s) failed\n", name, Failures());
+			return 1;
+		}
+		std::printf("%s: ok\n", name);
+		return 0;
+	}
+	// Fixed seed so that a failure reproduces.
+	inline std::mt19937& Random() {
+		static std::mt19937 random(12345);
+		return random;
+	}
+	inline size_t Below(size_t bound) {
+		return std::uniform_int_distribution<size_t>(0, bound - 1)(Random());
+	}
+}
+
+#define CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			test::Fail(__FILE__, __LINE__, "CHECK(" #expr ")"); \
+		} \
+	} while (0)
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const auto& check_actual = (actual); \
+		const auto& check_expected = (expected); \
+		if (!(check_actual == check_expected)) { \
+			test::Fail(__FILE__, __LINE__, "CHECK_EQ(" #actual ", " #expected "): " + test::Show(check_actual) + " != " + test::Show(check_expected)); \
+		} \
+	} while (0)
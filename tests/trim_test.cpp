@@ -0,0 +1,77 @@
+// Trim policies on narrow, wide and UTF-8 input, through the copying,
+// in-place, view and SplitTrim forms.
+#include "string_util.hpp"
+#include "test_util.hpp"
+
+namespace {
+	void TestPolicies() {
+		const std::string text = " \t x y \r\n ";
+		CHECK_EQ(cpp::Trim(text), std::string("\t x y \r\n"));
+		CHECK_EQ(cpp::Trim<cpp::AsciiSpace>(text), std::string("x y"));
+		CHECK_EQ(cpp::LTrim<cpp::AsciiSpace>(text), std::string("x y \r\n "));
+		CHECK_EQ(cpp::RTrim<cpp::AsciiSpace>(text), std::string(" \t x y"));
+		CHECK_EQ((cpp::Trim<cpp::SpaceSet<'-', '_'>>(std::string("-_a-b_-"))), std::string("a-b"));
+		CHECK_EQ(cpp::Trim(std::string("   ")), std::string());
+		CHECK_EQ(cpp::Trim(std::string()), std::string());
+
+		std::string inplace = "  both  ";
+		cpp::Trim(&inplace);
+		CHECK_EQ(inplace, std::string("both"));
+		inplace = "\t left";
+		cpp::LTrim<cpp::AsciiSpace>(&inplace);
+		CHECK_EQ(inplace, std::string("left"));
+
+		CHECK_EQ(cpp::TrimView(text), std::string_view("\t x y \r\n"));
+		CHECK_EQ(cpp::TrimView<cpp::AsciiSpace>(std::string_view(text)), std::string_view("x y"));
+		CHECK_EQ(cpp::TrimView<cpp::AsciiSpace>("\n z \n"), std::string_view("z"));
+	}
+	void TestUtf8() {
+		// U+00A0, U+3000, U+2003 and U+0085 around the text.
+		const std::string text = "\xC2\xA0\xE3\x80\x80 x\xC2\xA0y \xE2\x80\x83\xC2\x85";
+		CHECK_EQ(cpp::Trim<cpp::UnicodeSpace>(text), std::string("x\xC2\xA0y"));
+		CHECK_EQ(cpp::LTrim<cpp::UnicodeSpace>(text), std::string("x\xC2\xA0y \xE2\x80\x83\xC2\x85"));
+		CHECK_EQ(cpp::RTrim<cpp::UnicodeSpace>(text), std::string("\xC2\xA0\xE3\x80\x80 x\xC2\xA0y"));
+		// not spaces: other code points, truncated and stray continuation bytes.
+		CHECK_EQ(cpp::Trim<cpp::UnicodeSpace>(std::string("\xC3\xA9 ")), std::string("\xC3\xA9"));
+		CHECK_EQ(cpp::Trim<cpp::UnicodeSpace>(std::string(" \xE3\x80")), std::string("\xE3\x80"));
+		CHECK_EQ(cpp::Trim<cpp::UnicodeSpace>(std::string("\xA0 a \xC2")), std::string("\xA0 a \xC2"));
+		// the ASCII policies leave multibyte spaces alone.
+		CHECK_EQ(cpp::Trim<cpp::AsciiSpace>(std::string("\xC2\xA0 a")), std::string("\xC2\xA0 a"));
+
+		CHECK_EQ(cpp::SplitTrim<cpp::UnicodeSpace>(std::string("\xE3\x80\x80" "a ,\t b\xC2\xA0,"), ','),
+			(std::vector<std::string>{ "a", "b", "" }));
+	}
+	// Element-first calls from before the policy parameter still strip ' '.
+	void TestElementFirst() {
+		const std::string text = "  a ,\tb ";
+		CHECK_EQ(cpp::Trim<char>(text), std::string("a ,\tb"));
+		CHECK_EQ(cpp::LTrim<char>(text), std::string("a ,\tb "));
+		CHECK_EQ((cpp::RTrim<char, std::char_traits<char>, std::allocator<char>>(text)), std::string("  a ,\tb"));
+		std::string inplace = text;
+		cpp::Trim<char>(&inplace);
+		CHECK_EQ(inplace, std::string("a ,\tb"));
+		CHECK_EQ(cpp::SplitTrim<char>(text, ','), (std::vector<std::string>{ "a", "\tb" }));
+		std::vector<std::string> tokens;
+		cpp::SplitTrim<char>(text, ",", &tokens);
+		CHECK_EQ(tokens, (std::vector<std::string>{ "a", "\tb" }));
+		CHECK(cpp::Trim<wchar_t>(std::wstring(L" w ")) == L"w");
+		static_assert(cpp::detail::Is_Trim_Policy<cpp::SpaceSet<'-'>>::value, "policy");
+		static_assert(!cpp::detail::Is_Trim_Policy<char>::value, "not a policy");
+	}
+	void TestWide() {
+		const std::wstring text = L"\u3000\t w  ";
+		CHECK(cpp::Trim<cpp::UnicodeSpace>(text) == L"w");
+		CHECK(cpp::Trim<cpp::AsciiSpace>(text) == L"\u3000\t w");
+		CHECK(cpp::Trim(std::wstring(L"  w  ")) == L"w");
+		const std::u16string utf16 = u"\u2003x\u3000";
+		CHECK(cpp::TrimView<cpp::UnicodeSpace>(std::u16string_view(utf16)) == u"x");
+	}
+}
+
+int main() {
+	TestPolicies();
+	TestUtf8();
+	TestElementFirst();
+	TestWide();
+	return test::Report("trim_test");
+}